@@ -0,0 +1,80 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/*!
+ *  @file       main.cpp
+ *  @brief      Static cost of a frozen graph against its measured latency
+ *  @details    Prints the FLOPs and bytes of the most expensive ops, then
+ *              times the model and reports the achieved GFLOP/s and the
+ *              roofline efficiency for the peaks given on the command line
+ */
+
+// CppFlow headers
+#include <cppflow/ops.h>
+#include <cppflow/model.h>
+
+// C++ headers
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+constexpr size_t num_iter = 1000;
+
+int main(int argc, char* argv[]) {
+    // Peaks of the device, e.g. from the vendor datasheet
+    double peak_gflops = argc > 1 ? std::atof(argv[1]) : 100.0;
+    double peak_gbytes_per_s = argc > 2 ? std::atof(argv[2]) : 20.0;
+    const int batch_size = 10;
+
+    cppflow::model model(std::string(MODEL_PATH), {},
+                         cppflow::model::FROZEN_GRAPH);
+    auto cost = model.estimate_cost(batch_size);
+
+    std::cout << "batch size:       " << cost.batch_size << std::endl;
+    std::cout << "FLOPs:            " << cost.flops << std::endl;
+    std::cout << "parameter bytes:  " << cost.parameter_bytes << std::endl;
+    std::cout << "activation bytes: " << cost.activation_bytes << std::endl;
+    for (const auto& op : cost.ops)
+        std::cout << "  " << op.type << " " << op.name << ": " << op.flops
+                  << " FLOPs, " << op.bytes << " bytes" << std::endl;
+
+    auto input = cppflow::fill({batch_size, 5}, 1.0f);
+    model({{"x:0", input}}, {"Identity:0"});
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_iter; i++)
+        model({{"x:0", input}}, {"Identity:0"});
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    auto r = cost.roofline(elapsed.count() / num_iter, peak_gflops,
+                           peak_gbytes_per_s);
+    std::cout << "achieved:   " << r.achieved_gflops << " GFLOP/s" << std::endl;
+    std::cout << "intensity:  " << r.arithmetic_intensity << " FLOP/byte"
+              << std::endl;
+    std::cout << "attainable: " << r.attainable_gflops << " GFLOP/s"
+              << std::endl;
+    std::cout << "efficiency: " << 100.0 * r.efficiency << " %" << std::endl;
+    return 0;
+}
@@ -0,0 +1,84 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+
+/*!
+ *  @file       main.cpp
+ *  @brief      Ops called by name with cppflow::execute
+ *  @details    Calls ops with list outputs and attributes by name, then
+ *              times a MatMul through the generated op and by name
+ */
+
+// CppFlow headers
+#include <cppflow/cppflow.h>
+
+// C++ headers
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+constexpr size_t num_iter = 100000;
+
+template<typename Func>
+double ns_per_op(Func&& func) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_iter; i++)
+        func();
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / num_iter;
+}
+
+int main() {
+    auto x = cppflow::fill({4, 4}, 1.0f);
+    auto y = cppflow::fill({4, 4}, 2.0f);
+
+    // The number of outputs comes from the num_split attribute
+    auto parts = cppflow::execute("Split", {cppflow::tensor(0), x},
+                                  {{"num_split", 2}});
+    std::cout << "Split: " << parts.size() << " outputs of shape "
+              << parts[0].shape() << std::endl;
+
+    // A list input, its length sets the N attribute
+    auto sum = cppflow::execute("AddN", {{x, y, x}});
+    std::cout << "AddN: " << sum[0] << std::endl;
+
+    // Errors are reported from the OpDef, before the op runs
+    try {
+        cppflow::execute("MatMul", {x, y}, {{"transpose_c", true}});
+    } catch (const std::runtime_error& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+    }
+
+    // Both variants are run once first, so that the kernels are cached
+    auto generated = [&] { cppflow::mat_mul(x, y, true); };
+    auto by_name = [&] {
+        cppflow::execute("MatMul", {x, y}, {{"transpose_a", true}});
+    };
+    generated(); by_name();
+    std::cout << "MatMul generated: " << ns_per_op(generated) << " ns"
+              << std::endl;
+    std::cout << "MatMul by name:   " << ns_per_op(by_name) << " ns"
+              << std::endl;
+    return 0;
+}
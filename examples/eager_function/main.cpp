@@ -0,0 +1,89 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/*!
+ *  @file       main.cpp
+ *  @brief      Compares an eager preprocessing chain with its traced function
+ *  @details    Runs cast, expand_dims, resize and normalization op by op,
+ *              then as a cppflow::function that replays them as a single op
+ */
+
+// CppFlow headers
+#include <cppflow/function.h>
+#include <cppflow/ops.h>
+
+// C++ headers
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+constexpr size_t num_iter = 2048;
+
+template<typename Func>
+double time_per_call(Func&& func) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_iter; i++)
+        func();
+    std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / num_iter;
+}
+
+std::vector<cppflow::tensor> preprocess(
+        const std::vector<cppflow::tensor>& inputs) {
+    auto x = cppflow::cast(inputs[0], TF_UINT8, TF_FLOAT);
+    x = cppflow::expand_dims(x, cppflow::tensor(0));
+    x = cppflow::resize_bilinear(x, cppflow::tensor(std::vector<int>{16, 16},
+                                                    {2}));
+    x = (x / cppflow::tensor(255.0f) - cppflow::tensor(0.5f)) *
+        cppflow::tensor(2.0f);
+    return {x};
+}
+
+int main() {
+    std::vector<uint8_t> pixels(8 * 8 * 3, 128);
+    auto image = cppflow::tensor(pixels, {8, 8, 3});
+
+    cppflow::function traced(preprocess, "preprocess");
+
+    // The first call traces, and is checked against the eager result
+    auto eager_out = preprocess({image})[0];
+    auto traced_out = traced({image})[0];
+    std::cout << "eager:  " << eager_out.get_data<float>()[0] << std::endl;
+    std::cout << "traced: " << traced_out.get_data<float>()[0] << std::endl;
+
+    float sink = 0.0f;
+    double eager_us = time_per_call([&] {
+        sink += preprocess({image})[0].get_data<float>()[0];
+    });
+    double traced_us = time_per_call([&] {
+        sink += traced({image})[0].get_data<float>()[0];
+    });
+
+    std::cout << "eager ops: " << eager_us << " us/call" << std::endl;
+    std::cout << "function:  " << traced_us << " us/call ("
+              << traced.num_traces() << " trace)" << std::endl;
+    std::cout << "(checksum " << sink << ")" << std::endl;
+    return 0;
+}
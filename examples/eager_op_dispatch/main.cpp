@@ -0,0 +1,123 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/*!
+ *  @file       main.cpp
+ *  @brief      Per-op dispatch overhead of the generated eager ops
+ *  @details    Times add, mul and add_n on scalars, once through a TFE_Op
+ *              created and deleted for every call, as the generated ops
+ *              used to do, and once through the generated ops, which reuse
+ *              a per-thread TFE_Op
+ */
+
+// CppFlow headers
+#include <cppflow/ops.h>
+
+// C++ headers
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+constexpr size_t num_iter = 100000;
+
+template<typename Func>
+double ns_per_op(Func&& func) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_iter; i++)
+        func();
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / num_iter;
+}
+
+// A binary op with a new TFE_Op per call
+cppflow::tensor binary_new_op(const char* name, const cppflow::tensor& x,
+                              const cppflow::tensor& y) {
+    std::unique_ptr<TFE_Op, decltype(&TFE_DeleteOp)> op(
+        TFE_NewOp(cppflow::context::get_context(), name,
+                  cppflow::context::get_status()), &TFE_DeleteOp);
+    cppflow::status_check(cppflow::context::get_status());
+    TFE_OpAddInput(op.get(), x.get_eager_handle().get(),
+                   cppflow::context::get_status());
+    TFE_OpAddInput(op.get(), y.get_eager_handle().get(),
+                   cppflow::context::get_status());
+    cppflow::status_check(cppflow::context::get_status());
+    return cppflow::execute_op(op.get());
+}
+
+// AddN with a new TFE_Op and a heap-allocated handle list per call
+cppflow::tensor add_n_new_op(const std::vector<cppflow::tensor>& inputs) {
+    std::unique_ptr<TFE_Op, decltype(&TFE_DeleteOp)> op(
+        TFE_NewOp(cppflow::context::get_context(), "AddN",
+                  cppflow::context::get_status()), &TFE_DeleteOp);
+    cppflow::status_check(cppflow::context::get_status());
+    std::vector<TFE_TensorHandle*> handles;
+    handles.reserve(inputs.size());
+    for (const auto& t : inputs)
+        handles.push_back(t.get_eager_handle().get());
+    TFE_OpAddInputList(op.get(), handles.data(),
+                       static_cast<int>(handles.size()),
+                       cppflow::context::get_status());
+    cppflow::status_check(cppflow::context::get_status());
+    TFE_OpSetAttrInt(op.get(), "N", static_cast<int64_t>(inputs.size()));
+    return cppflow::execute_op(op.get());
+}
+
+int main() {
+    auto x = cppflow::tensor(1.0f);
+    auto y = cppflow::tensor(2.0f);
+    std::vector<cppflow::tensor> list = {x, y, x, y};
+
+    struct row {
+        const char* name;
+        double before;
+        double after;
+    };
+    std::vector<row> rows;
+
+    // Both variants are run once first, so that the kernels are cached
+    auto add_before = [&] { binary_new_op("Add", x, y); };
+    auto add_after = [&] { cppflow::add(x, y); };
+    add_before(); add_after();
+    rows.push_back({"add", ns_per_op(add_before), ns_per_op(add_after)});
+
+    auto mul_before = [&] { binary_new_op("Mul", x, y); };
+    auto mul_after = [&] { cppflow::mul(x, y); };
+    mul_before(); mul_after();
+    rows.push_back({"mul", ns_per_op(mul_before), ns_per_op(mul_after)});
+
+    auto add_n_before = [&] { add_n_new_op(list); };
+    auto add_n_after = [&] { cppflow::add_n(list); };
+    add_n_before(); add_n_after();
+    rows.push_back({"add_n", ns_per_op(add_n_before),
+                    ns_per_op(add_n_after)});
+
+    std::cout << "op       new TFE_Op   reused TFE_Op" << std::endl;
+    for (const auto& r : rows) {
+        std::cout << r.name << "\t " << r.before << " ns\t" << r.after
+                  << " ns (" << r.before - r.after << " ns saved)"
+                  << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/*!
+ *  @file       main.cpp
+ *  @brief      Exports a pruned and folded frozen graph of a SavedModel
+ *  @details    Prunes the graph to the serving output, strips Identity and
+ *              debug nodes, folds constants and writes the result, then
+ *              loads it back as a frozen graph and compares the outputs
+ */
+
+// CppFlow headers
+#include <cppflow/graph_transform.h>
+#include <cppflow/ops.h>
+#include <cppflow/model.h>
+
+// C++ headers
+#include <iostream>
+#include <string>
+
+int main() {
+    const std::string input = "serving_default_input_1:0";
+    const std::string output = "StatefulPartitionedCall:0";
+
+    cppflow::model model(std::string(MODEL_PATH));
+    auto report = cppflow::graph_transform(model)
+                      .prune({output})
+                      .strip()
+                      .fold_constants()
+                      .write("model_transformed.pb");
+
+    std::cout << "nodes:  " << report.nodes_before << " -> "
+              << report.nodes_after << " (" << report.pruned << " pruned, "
+              << report.stripped << " stripped, " << report.folded
+              << " folded)" << std::endl;
+    std::cout << "bytes:  " << report.bytes_before << " -> "
+              << report.bytes_after << std::endl;
+    std::cout << "import: " << report.import_ms_before << " ms -> "
+              << report.import_ms_after << " ms" << std::endl;
+
+    auto x = cppflow::fill({10, 5}, 1.0f);
+    cppflow::model frozen("model_transformed.pb", {},
+                          cppflow::model::FROZEN_GRAPH);
+    std::cout << "original:    " << model({{input, x}}, {output})[0]
+              << std::endl;
+    std::cout << "transformed: " << frozen({{input, x}}, {output})[0]
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,91 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/*!
+ *  @file       main.cpp
+ *  @brief      Measures the per-call cost of eager handles on model outputs
+ *  @details    Runs the multi input/output model and reads the outputs with
+ *              get_data() only, then again forcing the eager handle of every
+ *              output, as was done unconditionally before outputs were lazy
+ */
+
+// CppFlow headers
+#include <cppflow/ops.h>
+#include <cppflow/model.h>
+
+// C++ headers
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+constexpr size_t num_iter = 4096;
+
+template<typename Func>
+double time_per_call(Func&& func) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_iter; i++)
+        func();
+    std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / num_iter;
+}
+
+int main() {
+    auto input_1 = cppflow::fill({10, 5}, 1.0f);
+    auto input_2 = cppflow::fill({10, 5}, -1.0f);
+    cppflow::model model(std::string(MODEL_PATH));
+
+    const std::vector<std::tuple<std::string, cppflow::tensor>> inputs = {
+        {"serving_default_my_input_1:0", input_1},
+        {"serving_default_my_input_2:0", input_2}};
+    const std::vector<std::string> outputs = {"StatefulPartitionedCall:0",
+                                              "StatefulPartitionedCall:1"};
+
+    float sink = 0.0f;
+    auto data_only = [&] {
+        for (auto& out : model(inputs, outputs))
+            sink += out.get_data<float>()[0];
+    };
+    auto with_handles = [&] {
+        for (auto& out : model(inputs, outputs)) {
+            out.get_eager_handle();
+            sink += out.get_data<float>()[0];
+        }
+    };
+
+    // Warm up the session and the eager context
+    data_only();
+    with_handles();
+
+    double lazy_us = time_per_call(data_only);
+    double eager_us = time_per_call(with_handles);
+
+    std::cout << "get_data only:       " << lazy_us << " us/call" << std::endl;
+    std::cout << "eager handle forced: " << eager_us << " us/call" << std::endl;
+    std::cout << "saved per call:      " << eager_us - lazy_us << " us ("
+              << outputs.size() << " outputs)" << std::endl;
+    std::cout << "(checksum " << sink << ")" << std::endl;
+    return 0;
+}
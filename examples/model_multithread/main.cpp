@@ -0,0 +1,109 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/*!
+ *  @file       main.cpp
+ *  @brief      Runs one shared model from multiple threads
+ *  @details    Loads a single SavedModel and runs it concurrently from an
+ *              increasing number of threads, reporting the throughput
+ */
+
+// CppFlow headers
+#include <cppflow/ops.h>
+#include <cppflow/model.h>
+
+// C++ headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+constexpr size_t num_iter = 2048;
+
+void run(cppflow::model& model, const cppflow::tensor& input, float target) {
+    for (size_t i = 0; i < num_iter; i++) {
+        auto output = model(input);
+        float result_value = output.get_data<float>()[0];
+        if (std::abs(target - result_value) > 1e-6) {
+            std::cout << "error: result_value=" << result_value
+                      << ", target=" << target << std::endl;
+        }
+    }
+}
+
+int main() {
+    auto input = cppflow::fill({10, 5}, 1.0f);
+    cppflow::model model(std::string(MODEL_PATH));
+
+    // Build the executors before measuring, the first calls are much slower
+    cppflow::model::warmup_options warmup;
+    warmup.batch_sizes = {10};
+    for (const auto& r : model.warmup(warmup)) {
+        std::cout << "warmup " << r.signature << " (batch " << r.batch_size
+                  << "): cold " << r.cold_ms << " ms, warm " << r.warm_ms
+                  << " ms " << r.error << std::endl;
+    }
+
+    // Reference output, computed on a single thread
+    float target = model(input).get_data<float>()[0];
+
+    model.reset_metrics();
+
+    size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    double base_throughput = 0.0;
+    for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < num_threads; i++) {
+            threads.emplace_back(run, std::ref(model), std::cref(input),
+                                 target);
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        double throughput = num_threads * num_iter / elapsed.count();
+        if (num_threads == 1) base_throughput = throughput;
+
+        std::cout << num_threads << " threads: " << throughput
+                  << " calls/s (x" << throughput / base_throughput << ")"
+                  << std::endl;
+    }
+
+    // Where the time of a call goes, over all the runs above
+    auto metrics = model.metrics();
+    const char* stages[] = {"input", "run", "output", "total"};
+    for (size_t i = 0; i < metrics.stages.size(); i++) {
+        const auto& h = metrics.stages[i];
+        std::cout << stages[i] << ": mean " << 1e6 * h.mean_seconds()
+                  << " us, p50 " << 1e6 * h.percentile(0.5) << " us, p99 "
+                  << 1e6 * h.percentile(0.99) << " us" << std::endl;
+    }
+    std::cout << model.metrics_prometheus("model_multithread");
+
+    return 0;
+}
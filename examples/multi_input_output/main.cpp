@@ -50,5 +50,13 @@ int main() {
 
     std::cout << "output_1: " << output[0] << std::endl;
     std::cout << "output_2: " << output[1] << std::endl;
+
+    // Same call through the serving signature, using the Keras names
+    auto named_output = model.run("serving_default",
+                                  {{"my_input_1", input_1},
+                                   {"my_input_2", input_2}});
+
+    std::cout << "my_outputs_1: " << named_output["my_outputs_1"] << std::endl;
+    std::cout << "my_outputs_2: " << named_output["my_outputs_2"] << std::endl;
     return 0;
 }
@@ -0,0 +1,444 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/*!
+ *  @file       batcher.h
+ *  @brief      Dynamic micro-batching in front of a model
+ */
+
+#ifndef INCLUDE_CPPFLOW_BATCHER_H_
+#define INCLUDE_CPPFLOW_BATCHER_H_
+
+// C headers
+#include <tensorflow/c/c_api.h>
+
+// C++ headers
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+// CppFlow headers
+#include "cppflow/model.h"
+#include "cppflow/tensor.h"
+
+namespace cppflow {
+
+/**
+ * @class batcher
+ * @brief Groups requests from many threads into batched model calls
+ *
+ * Each request is a set of input tensors whose first dimension is the batch
+ * dimension. Queued requests are concatenated along dimension 0 into pooled
+ * host buffers, run with a single TF_SessionRun and the outputs are split
+ * back into one result per request.
+ */
+class batcher {
+ public:
+  struct options {
+    // Largest number of rows run in a single batch
+    size_t max_batch_size = 32;
+
+    // Longest time the oldest request waits for the batch to fill up
+    std::chrono::microseconds max_queue_delay{1000};
+
+    // If not empty, batches are padded up to the next allowed size so the
+    // executor only sees a few distinct shapes. Sorted on construction.
+    std::vector<size_t> allowed_batch_sizes;
+  };
+
+  /**
+   * Creates a batcher over the given model endpoints
+   * @param model The model to run, shared with the caller
+   * @param inputs Names of the input operations
+   * @param outputs Names of the output operations
+   * @param opts The batching options
+   */
+  batcher(const model& model, const std::vector<std::string>& inputs,
+          const std::vector<std::string>& outputs, options opts);
+  batcher(const model& model, const std::vector<std::string>& inputs,
+          const std::vector<std::string>& outputs)
+      : batcher(model, inputs, outputs, options()) {}
+
+  /**
+   * Creates a batcher over a signature of the model
+   * @param signature The signature, inputs and outputs are taken in key order
+   */
+  batcher(const model& model, const Signature& signature, options opts);
+  batcher(const model& model, const Signature& signature)
+      : batcher(model, signature, options()) {}
+
+  batcher(const batcher&) = delete;
+  batcher(batcher&&) = delete;
+
+  // Runs the requests still in the queue, then stops the worker
+  ~batcher();
+
+  batcher& operator=(const batcher&) = delete;
+  batcher& operator=(batcher&&) = delete;
+
+  /**
+   * Queues a request
+   * @param inputs One tensor per input, all with the same first dimension
+   * @return The outputs of this request, with the same first dimension
+   */
+  std::future<std::vector<tensor>> submit(std::vector<tensor> inputs);
+
+ private:
+  struct request {
+    std::vector<tensor> inputs;
+    int64_t rows;
+    std::chrono::steady_clock::time_point enqueued;
+    std::promise<std::vector<tensor>> result;
+  };
+
+  // Host buffers for the concatenated inputs, handed to TF with a
+  // deallocator that gives them back to the pool
+  class buffer_pool {
+   public:
+    ~buffer_pool();
+    void* acquire(size_t len);
+    void release(void* data, size_t len);
+
+   private:
+    std::mutex mutex;
+    std::map<size_t, std::vector<void*>> free_buffers;
+  };
+
+  static size_t pooled_size(size_t len);
+  static TF_Tensor* new_pooled_tensor(
+      const std::shared_ptr<buffer_pool>& pool, TF_DataType type,
+      const std::vector<int64_t>& dims, size_t len);
+
+  static bool compatible(const request& a, const request& b);
+  size_t padded_size(size_t rows) const;
+
+  void worker_loop();
+  void run_batch(std::vector<std::unique_ptr<request>>& batch);
+
+  prepared_call call;
+  options opts;
+  std::shared_ptr<buffer_pool> pool;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<std::unique_ptr<request>> queue;
+  int64_t queued_rows = 0;
+  bool stopping = false;
+  std::thread worker;
+};  // Class batcher
+
+}  // namespace cppflow
+
+
+/******************************
+ *   IMPLEMENTATION DETAILS   *
+ ******************************/
+
+
+namespace cppflow {
+
+inline batcher::batcher(const model& model,
+                        const std::vector<std::string>& inputs,
+                        const std::vector<std::string>& outputs, options opts)
+    : call(model.prepare(inputs, outputs)), opts(std::move(opts)),
+      pool(std::make_shared<buffer_pool>()) {
+  if (this->opts.max_batch_size == 0)
+    throw std::runtime_error("max_batch_size must be greater than zero");
+
+  std::sort(this->opts.allowed_batch_sizes.begin(),
+            this->opts.allowed_batch_sizes.end());
+
+  this->worker = std::thread(&batcher::worker_loop, this);
+}
+
+inline batcher::batcher(const model& model, const Signature& signature,
+                        options opts)
+    : batcher(model,
+              [&] {
+                std::vector<std::string> names;
+                for (const auto& [key, info] : signature.inputs)
+                  names.push_back(info.name);
+                return names;
+              }(),
+              [&] {
+                std::vector<std::string> names;
+                for (const auto& [key, info] : signature.outputs)
+                  names.push_back(info.name);
+                return names;
+              }(),
+              std::move(opts)) {}
+
+inline batcher::~batcher() {
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stopping = true;
+  }
+  this->cv.notify_all();
+  this->worker.join();
+}
+
+inline std::future<std::vector<tensor>> batcher::submit(
+    std::vector<tensor> inputs) {
+  if (inputs.size() != this->call.num_inputs())
+    throw std::runtime_error("Batcher expects " +
+                             std::to_string(this->call.num_inputs()) +
+                             " inputs, got " + std::to_string(inputs.size()));
+
+  auto req = std::make_unique<request>();
+  req->rows = -1;
+  for (const auto& input : inputs) {
+    auto t = input.get_tensor();
+    if (TF_TensorType(t.get()) == TF_STRING)
+      throw std::runtime_error("Batcher does not support string tensors");
+    if (TF_NumDims(t.get()) == 0)
+      throw std::runtime_error("Batcher inputs need a batch dimension");
+    if (req->rows != -1 && TF_Dim(t.get(), 0) != req->rows)
+      throw std::runtime_error("Batcher inputs must have the same "
+                               "first dimension");
+    req->rows = TF_Dim(t.get(), 0);
+  }
+  req->inputs = std::move(inputs);
+  req->enqueued = std::chrono::steady_clock::now();
+  auto result = req->result.get_future();
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->stopping)
+      throw std::runtime_error("Batcher is shutting down");
+    this->queued_rows += req->rows;
+    this->queue.push_back(std::move(req));
+  }
+  this->cv.notify_one();
+
+  return result;
+}
+
+inline bool batcher::compatible(const request& a, const request& b) {
+  for (decltype(a.inputs.size()) i=0; i < a.inputs.size(); i++) {
+    auto ta = a.inputs[i].get_tensor();
+    auto tb = b.inputs[i].get_tensor();
+    if (TF_TensorType(ta.get()) != TF_TensorType(tb.get()) ||
+        TF_NumDims(ta.get()) != TF_NumDims(tb.get()))
+      return false;
+    for (int d = 1; d < TF_NumDims(ta.get()); d++)
+      if (TF_Dim(ta.get(), d) != TF_Dim(tb.get(), d))
+        return false;
+  }
+  return true;
+}
+
+inline size_t batcher::padded_size(size_t rows) const {
+  auto it = std::lower_bound(this->opts.allowed_batch_sizes.begin(),
+                             this->opts.allowed_batch_sizes.end(), rows);
+  return it == this->opts.allowed_batch_sizes.end() ? rows : *it;
+}
+
+inline void batcher::worker_loop() {
+  std::unique_lock<std::mutex> lock(this->mutex);
+  const auto max_rows = static_cast<int64_t>(this->opts.max_batch_size);
+
+  while (true) {
+    this->cv.wait(lock, [this] {
+      return this->stopping || !this->queue.empty();
+    });
+    if (this->queue.empty())
+      return;
+
+    // Wait for the batch to fill up, at most until the oldest request
+    // has been waiting for max_queue_delay
+    auto deadline = this->queue.front()->enqueued + this->opts.max_queue_delay;
+    this->cv.wait_until(lock, deadline, [this, max_rows] {
+      return this->stopping || this->queued_rows >= max_rows;
+    });
+
+    // Take the oldest request and every following request with the same
+    // per-row shapes, as long as the batch does not grow too large
+    std::vector<std::unique_ptr<request>> batch;
+    int64_t rows = 0;
+    for (auto it = this->queue.begin(); it != this->queue.end();) {
+      if (!batch.empty() &&
+          (rows + (*it)->rows > max_rows || !compatible(*batch[0], **it))) {
+        ++it;
+        continue;
+      }
+      rows += (*it)->rows;
+      this->queued_rows -= (*it)->rows;
+      batch.push_back(std::move(*it));
+      it = this->queue.erase(it);
+      if (rows >= max_rows) break;
+    }
+
+    lock.unlock();
+    this->run_batch(batch);
+    lock.lock();
+  }
+}
+
+inline void batcher::run_batch(std::vector<std::unique_ptr<request>>& batch) {
+  const auto num_inputs = this->call.num_inputs();
+  const auto num_outputs = this->call.num_outputs();
+
+  int64_t rows = 0;
+  for (const auto& req : batch)
+    rows += req->rows;
+  const auto batch_rows = static_cast<int64_t>(this->padded_size(rows));
+
+  std::vector<TF_Tensor*> inp_val(num_inputs, nullptr);
+  std::vector<TF_Tensor*> out_val(num_outputs, nullptr);
+  auto release = [&] {
+    for (auto* t : inp_val) if (t) TF_DeleteTensor(t);
+    for (auto* t : out_val) if (t) TF_DeleteTensor(t);
+  };
+
+  try {
+    // Concatenate the inputs along dimension 0, zero-filling the padding
+    for (decltype(inp_val.size()) i=0; i < num_inputs; i++) {
+      auto first = batch[0]->inputs[i].get_tensor();
+      auto type = TF_TensorType(first.get());
+
+      std::vector<int64_t> dims(TF_NumDims(first.get()));
+      for (decltype(dims.size()) d=0; d < dims.size(); d++)
+        dims[d] = TF_Dim(first.get(), static_cast<int>(d));
+      dims[0] = batch_rows;
+
+      size_t row_bytes = TF_DataTypeSize(type);
+      for (decltype(dims.size()) d=1; d < dims.size(); d++)
+        row_bytes *= static_cast<size_t>(dims[d]);
+
+      inp_val[i] = new_pooled_tensor(this->pool, type, dims,
+                                     row_bytes * batch_rows);
+      auto* dst = static_cast<char*>(TF_TensorData(inp_val[i]));
+      for (const auto& req : batch) {
+        auto src = req->inputs[i].get_tensor();
+        std::memcpy(dst, TF_TensorData(src.get()), row_bytes * req->rows);
+        dst += row_bytes * req->rows;
+      }
+      std::memset(dst, 0, row_bytes * (batch_rows - rows));
+    }
+
+    this->call.run(inp_val.data(), out_val.data());
+
+    // Split every output back along dimension 0
+    std::vector<std::vector<tensor>> results(batch.size());
+    for (auto& r : results)
+      r.reserve(num_outputs);
+
+    for (decltype(out_val.size()) j=0; j < num_outputs; j++) {
+      auto* out = out_val[j];
+      if (TF_NumDims(out) == 0 || TF_Dim(out, 0) != batch_rows)
+        throw std::runtime_error("Batched output " + std::to_string(j) +
+                                 " does not have the batch dimension");
+      if (TF_TensorType(out) == TF_STRING)
+        throw std::runtime_error("Batcher does not support string tensors");
+
+      std::vector<int64_t> dims(TF_NumDims(out));
+      for (decltype(dims.size()) d=0; d < dims.size(); d++)
+        dims[d] = TF_Dim(out, static_cast<int>(d));
+      size_t row_bytes = batch_rows == 0 ? 0 :
+                         TF_TensorByteSize(out) / batch_rows;
+
+      const auto* src = static_cast<const char*>(TF_TensorData(out));
+      for (decltype(batch.size()) k=0; k < batch.size(); k++) {
+        dims[0] = batch[k]->rows;
+        auto* t = TF_AllocateTensor(TF_TensorType(out), dims.data(),
+                                    static_cast<int>(dims.size()),
+                                    row_bytes * batch[k]->rows);
+        std::memcpy(TF_TensorData(t), src, row_bytes * batch[k]->rows);
+        src += row_bytes * batch[k]->rows;
+        results[k].emplace_back(t);
+      }
+    }
+
+    release();
+    for (decltype(batch.size()) k=0; k < batch.size(); k++)
+      batch[k]->result.set_value(std::move(results[k]));
+  } catch (...) {
+    release();
+    for (auto& req : batch)
+      req->result.set_exception(std::current_exception());
+  }
+}
+
+inline size_t batcher::pooled_size(size_t len) {
+  // Round up to a power of two so that nearby batch shapes share buffers
+  size_t size = 64;
+  while (size < len) size <<= 1;
+  return size;
+}
+
+inline TF_Tensor* batcher::new_pooled_tensor(
+    const std::shared_ptr<buffer_pool>& pool, TF_DataType type,
+    const std::vector<int64_t>& dims, size_t len) {
+  // The deallocator may run after the batcher is gone (TF can hold on to
+  // its inputs), so it keeps its own reference to the pool
+  auto* owner = new std::shared_ptr<buffer_pool>(pool);
+  void* data = pool->acquire(len);
+  return TF_NewTensor(
+      type, dims.data(), static_cast<int>(dims.size()), data, len,
+      [](void* data, size_t len, void* arg) {
+        auto* owner = static_cast<std::shared_ptr<buffer_pool>*>(arg);
+        (*owner)->release(data, len);
+        delete owner;
+      },
+      owner);
+}
+
+inline batcher::buffer_pool::~buffer_pool() {
+  for (auto& [size, buffers] : this->free_buffers)
+    for (auto* data : buffers)
+      ::operator delete(data, std::align_val_t(64));
+}
+
+inline void* batcher::buffer_pool::acquire(size_t len) {
+  const size_t size = pooled_size(len);
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto& buffers = this->free_buffers[size];
+    if (!buffers.empty()) {
+      void* data = buffers.back();
+      buffers.pop_back();
+      return data;
+    }
+  }
+
+  // 64 byte alignment lets TF use the buffer without copying it
+  return ::operator new(size, std::align_val_t(64));
+}
+
+inline void batcher::buffer_pool::release(void* data, size_t len) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->free_buffers[pooled_size(len)].push_back(data);
+}
+
+}  // namespace cppflow
+
+#endif  // INCLUDE_CPPFLOW_BATCHER_H_
@@ -36,14 +36,27 @@
 #include <tensorflow/c/eager/c_api.h>
 
 // C++ headers
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <stdexcept>
 #include <utility>
 
 namespace cppflow {
 
+/**
+ * Thrown when a run is stopped by its deadline (TF_DEADLINE_EXCEEDED), or
+ * expires before it starts
+ */
+class deadline_exceeded : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
 inline bool status_check(TF_Status* status) {
-  if (TF_GetCode(status) != TF_OK) {
+  if (TF_GetCode(status) == TF_DEADLINE_EXCEEDED) {
+    throw deadline_exceeded(TF_Message(status));
+  } else if (TF_GetCode(status) != TF_OK) {
     throw std::runtime_error(TF_Message(status));
   }
   return true;
@@ -63,11 +76,19 @@ class context {
 
   static TFE_Context* get_context();
 
+  // Shares the ownership of the TFE_Context, which stays alive after the
+  // global context is replaced as long as a reference is held
+  static std::shared_ptr<TFE_Context> get_shared_context();
+
   // only use get_status() for eager ops
   static TF_Status* get_status();
 
+  // Identifies the global context, changes when it is replaced
+  static uint64_t get_context_id();
+
  private:
-  TFE_Context* tfe_context{nullptr};
+  std::shared_ptr<TFE_Context> tfe_context;
+  uint64_t id{0};
 };  // Class context
 
 // @todo create ContextManager class if needed
@@ -83,9 +104,17 @@ inline context& get_global_context() {
 namespace cppflow {
 
 inline TFE_Context* context::get_context() {
+  return get_global_context().tfe_context.get();
+}
+
+inline std::shared_ptr<TFE_Context> context::get_shared_context() {
   return get_global_context().tfe_context;
 }
 
+inline uint64_t context::get_context_id() {
+  return get_global_context().id;
+}
+
 inline TF_Status* context::get_status() {
   thread_local std::unique_ptr<TF_Status, decltype(&TF_DeleteStatus)>
       local_tf_status(TF_NewStatus(), &TF_DeleteStatus);
@@ -94,27 +123,32 @@ inline TF_Status* context::get_status() {
 
 inline context::context(TFE_ContextOptions* opts) {
   auto tf_status = context::get_status();
+  TFE_Context* tfe_ctx;
   if (opts == nullptr) {
     std::unique_ptr<TFE_ContextOptions, decltype(&TFE_DeleteContextOptions)>
         new_opts(TFE_NewContextOptions(), &TFE_DeleteContextOptions);
-    this->tfe_context = TFE_NewContext(new_opts.get(), tf_status);
+    tfe_ctx = TFE_NewContext(new_opts.get(), tf_status);
   } else {
-    this->tfe_context = TFE_NewContext(opts, tf_status);
+    tfe_ctx = TFE_NewContext(opts, tf_status);
   }
   status_check(tf_status);
+  this->tfe_context.reset(tfe_ctx, TFE_DeleteContext);
+
+  static std::atomic<uint64_t> num_contexts{0};
+  this->id = ++num_contexts;
 }
 
 inline context::context(context&& ctx) noexcept
-    : tfe_context(std::exchange(ctx.tfe_context, nullptr)) {}
+    : tfe_context(std::move(ctx.tfe_context)),
+      id(std::exchange(ctx.id, 0)) {}
 
 inline context& context::operator=(context&& ctx) noexcept {
-  tfe_context = std::exchange(ctx.tfe_context, tfe_context);
+  tfe_context.swap(ctx.tfe_context);
+  id = std::exchange(ctx.id, id);
   return *this;
 }
 
-inline context::~context() {
-  TFE_DeleteContext(this->tfe_context);
-}
+inline context::~context() = default;
 
 }  // namespace cppflow
 
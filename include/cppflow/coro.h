@@ -0,0 +1,387 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/*!
+ *  @file       coro.h
+ *  @brief      C++20 awaitables for model runs and eager op chains
+ *  @details    Optional header, empty unless compiled as C++20 with
+ *              <coroutine> available
+ */
+
+#ifndef INCLUDE_CPPFLOW_CORO_H_
+#define INCLUDE_CPPFLOW_CORO_H_
+
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+
+// C++ headers
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// CppFlow headers
+#include "cppflow/executor.h"
+#include "cppflow/model.h"
+#include "cppflow/tensor.h"
+
+namespace cppflow {
+
+/**
+ * Thrown by co_await when the awaited work was cancelled
+ */
+class cancelled_error : public std::runtime_error {
+ public:
+  cancelled_error() : std::runtime_error("Operation cancelled") {}
+};
+
+/**
+ * Thrown by co_await when the executor queue had no room for the work
+ */
+class queue_full_error : public std::runtime_error {
+ public:
+  queue_full_error() : std::runtime_error("The executor queue is full") {}
+};
+
+/**
+ * @class cancellation_token
+ * @brief Shared flag that cancels the awaitables it was given to
+ *
+ * Copies share the flag. Work that has not started is skipped; work that
+ * is already running on the executor can not be interrupted, but the
+ * awaiting coroutine is resumed right away and the result is dropped.
+ */
+class cancellation_token {
+ public:
+  cancellation_token() : state_(std::make_shared<state>()) {}
+
+  void cancel();
+  bool cancelled() const { return state_->cancelled.load(); }
+
+ private:
+  template<typename T> friend class awaitable;
+
+  struct state {
+    std::atomic<bool> cancelled{false};
+    std::mutex mutex;
+    size_t next_id = 1;
+    std::vector<std::pair<size_t, std::function<void()>>> callbacks;
+  };
+
+  // Calls func on cancel(), or now if already cancelled. Returns the id to
+  // unsubscribe with, 0 if func was called now.
+  size_t subscribe(std::function<void()> func) const;
+  void unsubscribe(size_t id) const;
+
+  std::shared_ptr<state> state_;
+};  // Class cancellation_token
+
+// Resumes an awaiting coroutine, e.g. by posting it to the coroutine
+// scheduler. When empty, the coroutine resumes on the cppflow worker.
+using resume_fn = std::function<void(std::coroutine_handle<>)>;
+
+struct await_options {
+  // Runs the work, get_global_executor() if null
+  executor* exec = nullptr;
+  resume_fn resume;
+  std::optional<cancellation_token> token;
+
+  // Deadline counted from the creation of the awaitable: work still queued
+  // when it expires fails with deadline_exceeded, model runs are cancelled
+  // past it. 0 for no limit.
+  std::chrono::milliseconds timeout{0};
+};
+
+/**
+ * @return A resume_fn that resumes coroutines on the given executor. The
+ *         resumption never waits for room in its queue.
+ */
+inline resume_fn resume_on(executor& exec) {
+  return [&exec](std::coroutine_handle<> h) {
+    exec.post_unbounded([h] { h.resume(); });
+  };
+}
+
+/**
+ * @class awaitable
+ * @brief Runs a function on an executor when awaited
+ *
+ * The awaiting coroutine is suspended while the function runs and resumed
+ * through await_options::resume. Only the executor workers block on
+ * TensorFlow, so the number of runs executing at once is bounded by the
+ * executor, not by the number of coroutines in flight.
+ */
+template<typename T>
+class awaitable {
+ public:
+  awaitable(std::function<T()> work, await_options opts);
+
+  bool await_ready() const noexcept { return false; }
+  bool await_suspend(std::coroutine_handle<> h);
+  T await_resume();
+
+ private:
+  using value_type = std::conditional_t<std::is_void_v<T>, bool, T>;
+
+  struct state {
+    std::function<T()> work;
+    await_options opts;
+
+    std::atomic<bool> done{false};
+    std::optional<value_type> value;
+    std::exception_ptr error;
+    std::coroutine_handle<> handle;
+    std::atomic<size_t> subscription{0};
+    std::chrono::steady_clock::time_point deadline;
+  };
+
+  // Only the first completion (result or cancellation) is kept. Returns
+  // false if the awaitable was already completed.
+  static bool complete(const std::shared_ptr<state>& s,
+                       std::optional<value_type> value,
+                       std::exception_ptr error);
+  static void resume(const std::shared_ptr<state>& s);
+
+  std::shared_ptr<state> state_;
+};  // Class awaitable
+
+/**
+ * Awaitable running func on an executor, e.g. a chain of eager ops
+ * @param func Callable without arguments
+ */
+template<typename Func>
+auto async(Func&& func, await_options opts = {})
+    -> awaitable<std::invoke_result_t<Func>>;
+
+/**
+ * Awaitable running the model, as model::operator()
+ * The names are resolved before returning, and the awaitable holds the
+ * session and copies of the inputs.
+ */
+awaitable<std::vector<tensor>> async_run(
+    const model& m,
+    const std::vector<std::tuple<std::string, tensor>>& inputs,
+    const std::vector<std::string>& outputs,
+    await_options opts = {});
+
+}  // namespace cppflow
+
+
+/******************************
+ *   IMPLEMENTATION DETAILS   *
+ ******************************/
+
+
+namespace cppflow {
+
+inline void cancellation_token::cancel() {
+  std::vector<std::pair<size_t, std::function<void()>>> callbacks;
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (state_->cancelled.exchange(true))
+      return;
+    callbacks.swap(state_->callbacks);
+  }
+  for (auto& c : callbacks)
+    c.second();
+}
+
+inline size_t cancellation_token::subscribe(std::function<void()> func) const {
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (!state_->cancelled) {
+      state_->callbacks.emplace_back(state_->next_id, std::move(func));
+      return state_->next_id++;
+    }
+  }
+  func();
+  return 0;
+}
+
+inline void cancellation_token::unsubscribe(size_t id) const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  auto& callbacks = state_->callbacks;
+  for (auto it = callbacks.begin(); it != callbacks.end(); ++it) {
+    if (it->first == id) {
+      callbacks.erase(it);
+      return;
+    }
+  }
+}
+
+template<typename T>
+awaitable<T>::awaitable(std::function<T()> work, await_options opts)
+    : state_(std::make_shared<state>()) {
+  state_->work = std::move(work);
+  state_->opts = std::move(opts);
+  state_->deadline = std::chrono::steady_clock::now() + state_->opts.timeout;
+}
+
+template<typename T>
+bool awaitable<T>::complete(const std::shared_ptr<state>& s,
+                            std::optional<value_type> value,
+                            std::exception_ptr error) {
+  if (s->done.exchange(true))
+    return false;
+  s->value = std::move(value);
+  s->error = error;
+  return true;
+}
+
+template<typename T>
+void awaitable<T>::resume(const std::shared_ptr<state>& s) {
+  if (s->opts.token)
+    s->opts.token->unsubscribe(s->subscription);
+
+  auto h = s->handle;
+  if (s->opts.resume)
+    s->opts.resume(h);
+  else
+    h.resume();
+}
+
+template<typename T>
+bool awaitable<T>::await_suspend(std::coroutine_handle<> h) {
+  auto s = state_;
+  if (s->opts.token && s->opts.token->cancelled()) {
+    complete(s, std::nullopt, std::make_exception_ptr(cancelled_error()));
+    return false;
+  }
+  s->handle = h;
+
+  // Taken before posting, so that a completion can not race with it
+  if (s->opts.token) {
+    s->subscription = s->opts.token->subscribe([s] {
+      if (complete(s, std::nullopt, std::make_exception_ptr(cancelled_error())))
+        resume(s);
+    });
+    if (s->done)
+      return true;  // Cancelled while subscribing, already resumed
+  }
+
+  auto task = [s] {
+    if (s->done)
+      return;  // Cancelled before it started
+    if (s->opts.timeout.count() > 0 &&
+        std::chrono::steady_clock::now() >= s->deadline) {
+      if (complete(s, std::nullopt, std::make_exception_ptr(deadline_exceeded(
+              "Deadline exceeded before the work started"))))
+        resume(s);
+      return;
+    }
+
+    std::optional<value_type> value;
+    std::exception_ptr error;
+    try {
+      if constexpr (std::is_void_v<T>) {
+        s->work();
+        value = true;
+      } else {
+        value = s->work();
+      }
+    } catch (...) {
+      error = std::current_exception();
+    }
+    if (complete(s, std::move(value), error))
+      resume(s);
+  };
+
+  // The coroutine thread does not wait for room in the executor: the
+  // awaitable fails with queue_full_error instead
+  std::exception_ptr error;
+  try {
+    executor& exec = s->opts.exec ? *s->opts.exec : get_global_executor();
+    if (!exec.try_post(std::move(task)))
+      error = std::make_exception_ptr(queue_full_error());
+  } catch (...) {
+    error = std::current_exception();
+  }
+  if (!error || !complete(s, std::nullopt, error))
+    return true;
+
+  // Not posted, the coroutine continues right away
+  if (s->opts.token)
+    s->opts.token->unsubscribe(s->subscription);
+  return false;
+}
+
+template<typename T>
+T awaitable<T>::await_resume() {
+  if (state_->error)
+    std::rethrow_exception(state_->error);
+  if constexpr (!std::is_void_v<T>)
+    return std::move(*state_->value);
+}
+
+template<typename Func>
+auto async(Func&& func, await_options opts)
+    -> awaitable<std::invoke_result_t<Func>> {
+  return awaitable<std::invoke_result_t<Func>>(std::forward<Func>(func),
+                                               std::move(opts));
+}
+
+inline awaitable<std::vector<tensor>> async_run(
+    const model& m,
+    const std::vector<std::tuple<std::string, tensor>>& inputs,
+    const std::vector<std::string>& outputs,
+    await_options opts) {
+  std::vector<std::string> names;
+  std::vector<tensor> values;
+  names.reserve(inputs.size());
+  values.reserve(inputs.size());
+  for (const auto& [name, value] : inputs) {
+    names.push_back(name);
+    values.push_back(value);
+  }
+
+  auto call = std::make_shared<prepared_call>(m.prepare(names, outputs));
+  const auto timeout = opts.timeout;
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  return awaitable<std::vector<tensor>>(
+      [call, values = std::move(values), timeout, deadline] {
+        if (timeout.count() > 0) {
+          // At least 1 ms, the awaitable already checked the deadline
+          call->set_timeout(std::max(std::chrono::milliseconds(1),
+              std::chrono::duration_cast<std::chrono::milliseconds>(
+                  deadline - std::chrono::steady_clock::now())));
+        }
+        return (*call)(values);
+      },
+      std::move(opts));
+}
+
+}  // namespace cppflow
+
+#endif  // __cplusplus >= 202002L && __has_include(<coroutine>)
+
+#endif  // INCLUDE_CPPFLOW_CORO_H_
@@ -38,10 +38,21 @@
 #include <string>
 
 // CppFlow headers
+#include "cppflow/batcher.h"
+#include "cppflow/coro.h"
 #include "cppflow/datatype.h"
+#include "cppflow/dynamic_op.h"
+#include "cppflow/graph_transform.h"
+#include "cppflow/executor.h"
+#include "cppflow/function.h"
+#include "cppflow/metrics.h"
 #include "cppflow/model.h"
+#include "cppflow/model_pool.h"
+#include "cppflow/model_registry.h"
+#include "cppflow/model_server.h"
 #include "cppflow/ops.h"
 #include "cppflow/raw_ops.h"
+#include "cppflow/result_cache.h"
 #include "cppflow/tensor.h"
 
 namespace cppflow {
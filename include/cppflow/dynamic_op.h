@@ -0,0 +1,758 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/*!
+ *  @file       dynamic_op.h
+ *  @brief      Eager ops called by name, with their attributes in a map
+ */
+
+#ifndef INCLUDE_CPPFLOW_DYNAMIC_OP_H_
+#define INCLUDE_CPPFLOW_DYNAMIC_OP_H_
+
+// C headers
+#include <tensorflow/c/c_api.h>
+#include <tensorflow/c/eager/c_api.h>
+#include <tensorflow/c/eager/c_api_experimental.h>
+#include <tensorflow/c/tf_tensor.h>
+
+// C++ headers
+#include <cstdint>
+#include <initializer_list>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// CppFlow headers
+#include "cppflow/context.h"
+#include "cppflow/datatype.h"
+#include "cppflow/op_dispatch.h"
+#include "cppflow/pb_helper.h"
+#include "cppflow/tensor.h"
+
+namespace cppflow {
+
+/**
+ * @class attr_value
+ * @brief The value of an op attribute
+ *
+ * The value is converted to the type the OpDef gives the attribute when it
+ * is set: a list of integers is a shape or a list(int), an integer can set
+ * a float and a string can name a function. An empty list, e.g. {}, sets a
+ * list attribute of any type, or a scalar shape.
+ */
+class attr_value {
+ public:
+  enum class kind {
+    integer, real, boolean, type, string, tensor,
+    int_list, float_list, bool_list, type_list, string_list, shape_list
+  };
+
+  attr_value() : kind_(kind::int_list) {}
+
+  template<typename T, typename std::enable_if<
+      std::is_arithmetic<T>::value, int>::type = 0>
+  attr_value(T value);
+
+  attr_value(datatype value) : kind_(kind::type), type_(value) {}
+  attr_value(const char* value) : kind_(kind::string), string_(value) {}
+  attr_value(std::string value)
+      : kind_(kind::string), string_(std::move(value)) {}
+  attr_value(tensor value) : kind_(kind::tensor), tensor_(std::move(value)) {}
+
+  template<typename T>
+  attr_value(std::initializer_list<T> values);
+
+  template<typename T>
+  attr_value(const std::vector<T>& values);
+
+  kind get_kind() const { return this->kind_; }
+
+  /**
+   * Sets the attribute on an op
+   * @param op The op
+   * @param name Name of the attribute
+   * @param type Type of the attribute in the OpDef, e.g. "list(int)"
+   */
+  void set(TFE_Op* op, const std::string& name, const std::string& type) const;
+
+  /**
+   * Appends the value to a cache key
+   * @return false if the value can not be part of a key, i.e. a tensor
+   */
+  bool append_key(std::string* key) const;
+
+  /**
+   * @return The number of elements of a list, or the value of an integer
+   */
+  int64_t count() const;
+
+ private:
+  template<typename T>
+  void assign_list(const T* values, size_t size);
+
+  kind kind_;
+  int64_t int_ = 0;
+  float float_ = 0;
+  datatype type_ = TF_FLOAT;
+  std::string string_;
+  tensor tensor_;
+
+  std::vector<int64_t> ints_;
+  std::vector<float> floats_;
+  std::vector<unsigned char> bools_;
+  std::vector<datatype> types_;
+  std::vector<std::string> strings_;
+  std::vector<std::vector<int64_t>> shapes_;
+};  // Class attr_value
+
+using attr_map = std::map<std::string, attr_value>;
+
+/**
+ * @class op_input
+ * @brief One input argument of an op: a tensor, or a list of tensors
+ *
+ * It refers to the tensors it is given without copying them, so it must
+ * not outlive the call it is passed to. A braced list is copied.
+ */
+class op_input {
+ public:
+  op_input(const tensor& value) : data(&value), size_(1), list(false) {}
+  op_input(const std::vector<tensor>& values)
+      : data(values.data()), size_(values.size()), list(true) {}
+  op_input(std::initializer_list<tensor> values)
+      : owned(values), list(true) {}
+
+  const tensor* begin() const {
+    return this->data ? this->data : this->owned.data();
+  }
+  const tensor* end() const { return this->begin() + this->size(); }
+  size_t size() const { return this->data ? this->size_ : this->owned.size(); }
+  bool is_list() const { return this->list; }
+
+ private:
+  const tensor* data = nullptr;
+  size_t size_ = 0;
+  std::vector<tensor> owned;
+  bool list;
+};  // Class op_input
+
+/**
+ * @struct op_def_info
+ * @brief The parts of an OpDef needed to call the op
+ */
+struct op_def_info {
+  struct arg {
+    std::string name;
+    std::string type_attr;
+    std::string number_attr;
+    std::string type_list_attr;
+  };
+
+  struct attr {
+    std::string type;
+    bool has_default = false;
+    int64_t default_int = 0;
+  };
+
+  std::string name;
+  std::vector<arg> inputs;
+  std::vector<arg> outputs;
+  std::map<std::string, attr> attrs;
+
+  /**
+   * @param op_name Name of a registered op, e.g. "MatMul"
+   * @return The definition of the op, read from TF_GetAllOpList once
+   */
+  static std::shared_ptr<const op_def_info> find(const std::string& op_name);
+
+  static op_def_info parse(const std::string& op_def);
+};  // Struct op_def_info
+
+/**
+ * @class dynamic_op
+ * @brief An op known by name, with its attributes set once
+ *
+ * The attributes are checked against the OpDef and set on a TFE_Op kept
+ * as a template. Each call copies them from it into a reused TFE_Op, adds
+ * the inputs and executes it. Like the TFE_Op of the generated ops, a
+ * dynamic_op belongs to one thread.
+ */
+class dynamic_op {
+ public:
+  /**
+   * @param op_name Name of the op, e.g. "MatMul"
+   * @param attrs Attributes that are not inferred from the inputs and
+   *              have no default in the OpDef, or overriding it
+   */
+  dynamic_op(std::string op_name, attr_map attrs = {});
+
+  dynamic_op(const dynamic_op&) = delete;
+  dynamic_op& operator=(const dynamic_op&) = delete;
+
+  /**
+   * @param inputs One entry per input argument of the op
+   * @param num_outputs Number of outputs, -1 to derive it from the OpDef
+   * @return The outputs of the op
+   */
+  std::vector<tensor> operator()(const std::vector<op_input>& inputs,
+                                 int num_outputs = -1);
+
+  const std::string& name() const { return this->op_name; }
+  bool in_use() const { return this->slot.in_use; }
+
+ private:
+  void prepare();
+  int count_outputs(const std::vector<op_input>& inputs) const;
+
+  std::string op_name;
+  attr_map attrs;
+  std::shared_ptr<const op_def_info> def;
+
+  // Holds the attributes only, copied into the executed op at every call
+  op_slot attrs_op;
+  op_slot slot;
+};  // Class dynamic_op
+
+/**
+ * Executes any registered op, including ops without a generated wrapper:
+ * ops of newer TensorFlow versions, ops with function attributes or
+ * custom ops. Each thread keeps the prepared op of every op name and
+ * attributes it called, so repeated calls only add the inputs.
+ * @param op_name Name of the op, e.g. "MatMul"
+ * @param inputs One entry per input argument of the op
+ * @param attrs Attributes that are not inferred from the inputs
+ * @param num_outputs Number of outputs, -1 to derive it from the OpDef
+ * @return The outputs of the op
+ */
+std::vector<tensor> execute(const std::string& op_name,
+                            const std::vector<op_input>& inputs,
+                            const attr_map& attrs = {}, int num_outputs = -1);
+
+}  // namespace cppflow
+
+
+/******************************
+ *   IMPLEMENTATION DETAILS   *
+ ******************************/
+
+
+namespace cppflow {
+
+template<typename T, typename std::enable_if<
+    std::is_arithmetic<T>::value, int>::type>
+attr_value::attr_value(T value) {
+  if constexpr (std::is_same<T, bool>::value) {
+    this->kind_ = kind::boolean;
+    this->int_ = value;
+  } else if constexpr (std::is_integral<T>::value) {
+    this->kind_ = kind::integer;
+    this->int_ = static_cast<int64_t>(value);
+  } else {
+    this->kind_ = kind::real;
+    this->float_ = static_cast<float>(value);
+  }
+}
+
+template<typename T>
+attr_value::attr_value(std::initializer_list<T> values) {
+  this->assign_list(values.begin(), values.size());
+}
+
+template<typename T>
+attr_value::attr_value(const std::vector<T>& values) {
+  this->assign_list(values.data(), values.size());
+}
+
+template<typename T>
+void attr_value::assign_list(const T* values, size_t size) {
+  if constexpr (std::is_same<T, bool>::value) {
+    this->kind_ = kind::bool_list;
+    this->bools_.assign(values, values + size);
+  } else if constexpr (std::is_integral<T>::value) {
+    this->kind_ = kind::int_list;
+    this->ints_.assign(values, values + size);
+  } else if constexpr (std::is_floating_point<T>::value) {
+    this->kind_ = kind::float_list;
+    this->floats_.assign(values, values + size);
+  } else if constexpr (std::is_same<T, datatype>::value) {
+    this->kind_ = kind::type_list;
+    this->types_.assign(values, values + size);
+  } else if constexpr (std::is_convertible<T, std::string>::value) {
+    this->kind_ = kind::string_list;
+    this->strings_.assign(values, values + size);
+  } else {
+    static_assert(std::is_convertible<T, std::vector<int64_t>>::value,
+                  "Unsupported attribute list type");
+    this->kind_ = kind::shape_list;
+    this->shapes_.assign(values, values + size);
+  }
+}
+
+inline void attr_value::set(TFE_Op* op, const std::string& name,
+                            const std::string& type) const {
+  const char* attr = name.c_str();
+  const bool empty_list = this->kind_ == kind::int_list && this->ints_.empty();
+  const auto mismatch = [&] {
+    return std::runtime_error("Attribute " + name + " of " +
+                              TFE_OpGetName(op, context::get_status()) +
+                              " must be a " + type);
+  };
+
+  if (type == "int" && this->kind_ == kind::integer) {
+    TFE_OpSetAttrInt(op, attr, this->int_);
+  } else if (type == "float" && this->kind_ == kind::real) {
+    TFE_OpSetAttrFloat(op, attr, this->float_);
+  } else if (type == "float" && this->kind_ == kind::integer) {
+    TFE_OpSetAttrFloat(op, attr, static_cast<float>(this->int_));
+  } else if (type == "bool" && this->kind_ == kind::boolean) {
+    TFE_OpSetAttrBool(op, attr, static_cast<unsigned char>(this->int_));
+  } else if (type == "type" && this->kind_ == kind::type) {
+    TFE_OpSetAttrType(op, attr, this->type_);
+  } else if (type == "string" && this->kind_ == kind::string) {
+    TFE_OpSetAttrString(op, attr, this->string_.data(), this->string_.size());
+  } else if (type == "func" && this->kind_ == kind::string) {
+    TFE_OpSetAttrFunctionName(op, attr, this->string_.data(),
+                              this->string_.size());
+  } else if (type == "tensor" && this->kind_ == kind::tensor) {
+    TFE_OpSetAttrTensor(op, attr, this->tensor_.get_tensor().get(),
+                        context::get_status());
+    status_check(context::get_status());
+  } else if (type == "shape" && this->kind_ == kind::int_list) {
+    TFE_OpSetAttrShape(op, attr, this->ints_.data(),
+                       static_cast<int>(this->ints_.size()),
+                       context::get_status());
+    status_check(context::get_status());
+  } else if (type == "list(int)" && this->kind_ == kind::int_list) {
+    TFE_OpSetAttrIntList(op, attr, this->ints_.data(),
+                         static_cast<int>(this->ints_.size()));
+  } else if (type == "list(float)" && this->kind_ == kind::float_list) {
+    TFE_OpSetAttrFloatList(op, attr, this->floats_.data(),
+                           static_cast<int>(this->floats_.size()));
+  } else if (type == "list(float)" && this->kind_ == kind::int_list) {
+    std::vector<float> values(this->ints_.begin(), this->ints_.end());
+    TFE_OpSetAttrFloatList(op, attr, values.data(),
+                           static_cast<int>(values.size()));
+  } else if (type == "list(bool)" &&
+             (this->kind_ == kind::bool_list || empty_list)) {
+    TFE_OpSetAttrBoolList(op, attr, this->bools_.data(),
+                          static_cast<int>(this->bools_.size()));
+  } else if (type == "list(type)" &&
+             (this->kind_ == kind::type_list || empty_list)) {
+    TFE_OpSetAttrTypeList(op, attr, this->types_.data(),
+                          static_cast<int>(this->types_.size()));
+  } else if (type == "list(string)" &&
+             (this->kind_ == kind::string_list || empty_list)) {
+    small_buffer<const void*> values(this->strings_.size());
+    small_buffer<size_t> lengths(this->strings_.size());
+    for (size_t i = 0; i < this->strings_.size(); i++) {
+      values.data()[i] = this->strings_[i].data();
+      lengths.data()[i] = this->strings_[i].size();
+    }
+    TFE_OpSetAttrStringList(op, attr, values.data(), lengths.data(),
+                            static_cast<int>(this->strings_.size()));
+  } else if (type == "list(shape)" &&
+             (this->kind_ == kind::shape_list || empty_list)) {
+    small_buffer<const int64_t*> dims(this->shapes_.size());
+    small_buffer<int> num_dims(this->shapes_.size());
+    for (size_t i = 0; i < this->shapes_.size(); i++) {
+      dims.data()[i] = this->shapes_[i].data();
+      num_dims.data()[i] = static_cast<int>(this->shapes_[i].size());
+    }
+    TFE_OpSetAttrShapeList(op, attr, dims.data(), num_dims.data(),
+                           static_cast<int>(this->shapes_.size()),
+                           context::get_status());
+    status_check(context::get_status());
+  } else {
+    throw mismatch();
+  }
+}
+
+inline bool attr_value::append_key(std::string* key) const {
+  const auto append = [key](const void* data, size_t size) {
+    key->append(static_cast<const char*>(data), size);
+  };
+  const auto append_size = [&](size_t size) { append(&size, sizeof(size)); };
+
+  key->push_back(static_cast<char>(this->kind_));
+  switch (this->kind_) {
+    case kind::integer:
+    case kind::boolean:
+      append(&this->int_, sizeof(this->int_));
+      break;
+    case kind::real:
+      append(&this->float_, sizeof(this->float_));
+      break;
+    case kind::type:
+      append(&this->type_, sizeof(this->type_));
+      break;
+    case kind::string:
+      append_size(this->string_.size());
+      key->append(this->string_);
+      break;
+    case kind::tensor:
+      return false;
+    case kind::int_list:
+      append_size(this->ints_.size());
+      append(this->ints_.data(), this->ints_.size() * sizeof(int64_t));
+      break;
+    case kind::float_list:
+      append_size(this->floats_.size());
+      append(this->floats_.data(), this->floats_.size() * sizeof(float));
+      break;
+    case kind::bool_list:
+      append_size(this->bools_.size());
+      append(this->bools_.data(), this->bools_.size());
+      break;
+    case kind::type_list:
+      append_size(this->types_.size());
+      append(this->types_.data(), this->types_.size() * sizeof(datatype));
+      break;
+    case kind::string_list:
+      append_size(this->strings_.size());
+      for (const auto& s : this->strings_) {
+        append_size(s.size());
+        key->append(s);
+      }
+      break;
+    case kind::shape_list:
+      append_size(this->shapes_.size());
+      for (const auto& s : this->shapes_) {
+        append_size(s.size());
+        append(s.data(), s.size() * sizeof(int64_t));
+      }
+      break;
+  }
+  return true;
+}
+
+inline int64_t attr_value::count() const {
+  switch (this->kind_) {
+    case kind::integer: return this->int_;
+    case kind::int_list: return static_cast<int64_t>(this->ints_.size());
+    case kind::float_list: return static_cast<int64_t>(this->floats_.size());
+    case kind::bool_list: return static_cast<int64_t>(this->bools_.size());
+    case kind::type_list: return static_cast<int64_t>(this->types_.size());
+    case kind::string_list:
+      return static_cast<int64_t>(this->strings_.size());
+    case kind::shape_list: return static_cast<int64_t>(this->shapes_.size());
+    default: return -1;
+  }
+}
+
+inline std::shared_ptr<const op_def_info> op_def_info::find(
+    const std::string& op_name) {
+  static std::mutex mutex;
+  static std::map<std::string, std::string> op_defs;
+  static std::map<std::string, std::shared_ptr<const op_def_info>> parsed;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = parsed.find(op_name);
+  if (it != parsed.end())
+    return it->second;
+
+  auto op_def = op_defs.find(op_name);
+  if (op_def == op_defs.end()) {
+    // First lookup, or an op registered since the last one, e.g. by
+    // TF_LoadLibrary. OpList -> Field 1 is "op", OpDef -> Field 1 "name"
+    std::unique_ptr<TF_Buffer, decltype(&TF_DeleteBuffer)> buf = {
+        TF_GetAllOpList(), TF_DeleteBuffer};
+    ProtoReader op_list(static_cast<const uint8_t*>(buf->data), buf->length);
+    op_defs.clear();
+    while (!op_list.eof()) {
+      uint64_t tag = op_list.read_varint();
+      if ((tag >> 3) != 1 || (tag & 7) != 2) {
+        op_list.skip(tag & 7);
+        continue;
+      }
+      std::string blob = op_list.read_string();
+      ProtoReader reader(blob);
+      while (!reader.eof()) {
+        uint64_t field_tag = reader.read_varint();
+        if ((field_tag >> 3) == 1 && (field_tag & 7) == 2) {
+          std::string name = reader.read_string();
+          op_defs.emplace(std::move(name), std::move(blob));
+          break;
+        }
+        reader.skip(field_tag & 7);
+      }
+    }
+
+    op_def = op_defs.find(op_name);
+    if (op_def == op_defs.end())
+      throw std::runtime_error("No op named " + op_name + " is registered");
+  }
+
+  auto result = std::make_shared<const op_def_info>(parse(op_def->second));
+  parsed.emplace(op_name, result);
+  return result;
+}
+
+inline op_def_info op_def_info::parse(const std::string& op_def) {
+  // OpDef -> Field 1 "name", 2 "input_arg", 3 "output_arg", 4 "attr"
+  // ArgDef -> Field 1 "name", 4 "type_attr", 5 "number_attr",
+  //           6 "type_list_attr"
+  // AttrDef -> Field 1 "name", 2 "type", 3 "default_value"
+  // AttrValue -> Field 3 is "i"
+  op_def_info result;
+  ProtoReader reader(op_def);
+  while (!reader.eof()) {
+    uint64_t tag = reader.read_varint();
+    uint64_t field = tag >> 3;
+    if ((tag & 7) != 2 || field < 1 || field > 4) {
+      reader.skip(tag & 7);
+      continue;
+    }
+    std::string blob = reader.read_string();
+    if (field == 1) {
+      result.name = std::move(blob);
+      continue;
+    }
+
+    ProtoReader sub(blob);
+    if (field == 2 || field == 3) {
+      arg a;
+      while (!sub.eof()) {
+        uint64_t sub_tag = sub.read_varint();
+        uint64_t sub_field = sub_tag >> 3;
+        if ((sub_tag & 7) != 2) {
+          sub.skip(sub_tag & 7);
+          continue;
+        }
+        std::string value = sub.read_string();
+        if (sub_field == 1) a.name = std::move(value);
+        else if (sub_field == 4) a.type_attr = std::move(value);
+        else if (sub_field == 5) a.number_attr = std::move(value);
+        else if (sub_field == 6) a.type_list_attr = std::move(value);
+      }
+      (field == 2 ? result.inputs : result.outputs).push_back(std::move(a));
+      continue;
+    }
+
+    std::string name;
+    attr a;
+    while (!sub.eof()) {
+      uint64_t sub_tag = sub.read_varint();
+      uint64_t sub_field = sub_tag >> 3;
+      if ((sub_tag & 7) != 2 || sub_field < 1 || sub_field > 3) {
+        sub.skip(sub_tag & 7);
+        continue;
+      }
+      std::string value = sub.read_string();
+      if (sub_field == 1) {
+        name = std::move(value);
+      } else if (sub_field == 2) {
+        a.type = std::move(value);
+      } else {
+        a.has_default = true;
+        ProtoReader default_value(value);
+        while (!default_value.eof()) {
+          uint64_t value_tag = default_value.read_varint();
+          if (value_tag == ((3 << 3) | 0))
+            a.default_int = static_cast<int64_t>(default_value.read_varint());
+          else
+            default_value.skip(value_tag & 7);
+        }
+      }
+    }
+    result.attrs.emplace(std::move(name), std::move(a));
+  }
+  return result;
+}
+
+inline dynamic_op::dynamic_op(std::string op_name, attr_map attrs)
+    : op_name(std::move(op_name)), attrs(std::move(attrs)) {
+  this->def = op_def_info::find(this->op_name);
+
+  // Attributes the inputs set when they are added to the op
+  std::set<std::string> inferred;
+  for (const auto& input : this->def->inputs) {
+    inferred.insert(input.type_attr);
+    inferred.insert(input.number_attr);
+    inferred.insert(input.type_list_attr);
+  }
+
+  for (const auto& entry : this->attrs) {
+    if (!this->def->attrs.count(entry.first))
+      throw std::runtime_error(this->op_name + " has no attribute " +
+                               entry.first);
+  }
+  for (const auto& [name, attr] : this->def->attrs) {
+    if (!attr.has_default && !inferred.count(name) && !this->attrs.count(name))
+      throw std::runtime_error("Attribute " + name + " of " + this->op_name +
+                               " is required");
+  }
+
+  this->prepare();
+}
+
+inline void dynamic_op::prepare() {
+  this->attrs_op.create(this->op_name.c_str());
+  try {
+    for (const auto& [name, value] : this->attrs)
+      value.set(this->attrs_op.op, name, this->def->attrs.at(name).type);
+  } catch (...) {
+    this->attrs_op.reset();
+    throw;
+  }
+}
+
+inline int dynamic_op::count_outputs(
+    const std::vector<op_input>& inputs) const {
+  // Length of a list sized by attr, from the attributes or the inputs
+  const auto list_length = [&](const std::string& attr) -> int64_t {
+    auto value = this->attrs.find(attr);
+    if (value != this->attrs.end())
+      return value->second.count();
+    for (size_t i = 0; i < inputs.size(); i++) {
+      const auto& input = this->def->inputs[i];
+      if (input.number_attr == attr || input.type_list_attr == attr)
+        return static_cast<int64_t>(inputs[i].size());
+    }
+    auto def_attr = this->def->attrs.find(attr);
+    if (def_attr != this->def->attrs.end() && def_attr->second.has_default &&
+        def_attr->second.type == "int")
+      return def_attr->second.default_int;
+    return -1;
+  };
+
+  int64_t result = 0;
+  for (const auto& output : this->def->outputs) {
+    int64_t length = 1;
+    if (!output.number_attr.empty())
+      length = list_length(output.number_attr);
+    else if (!output.type_list_attr.empty())
+      length = list_length(output.type_list_attr);
+    if (length < 0)
+      return -1;
+    result += length;
+  }
+  return static_cast<int>(result);
+}
+
+inline std::vector<tensor> dynamic_op::operator()(
+    const std::vector<op_input>& inputs, int num_outputs) {
+  if (inputs.size() != this->def->inputs.size())
+    throw std::runtime_error(
+        this->op_name + " takes " + std::to_string(this->def->inputs.size()) +
+        " inputs, " + std::to_string(inputs.size()) + " given");
+
+  const int expected = this->count_outputs(inputs);
+  if (num_outputs < 0 && expected < 0)
+    throw std::runtime_error("The number of outputs of " + this->op_name +
+                             " is not known from its attributes, pass it");
+  if (num_outputs >= 0 && expected >= 0 && num_outputs != expected)
+    throw std::runtime_error(
+        this->op_name + " has " + std::to_string(expected) + " outputs, " +
+        std::to_string(num_outputs) + " requested");
+
+  if (this->attrs_op.context.get() != context::get_context())
+    this->prepare();
+
+  cached_op op(this->slot, this->op_name.c_str());
+  TFE_OpAddAttrs(op.get(), TFE_OpGetAttrs(this->attrs_op.op));
+
+  for (size_t i = 0; i < inputs.size(); i++) {
+    const auto& arg = this->def->inputs[i];
+    const bool is_list = !arg.number_attr.empty() ||
+                         !arg.type_list_attr.empty();
+    if (!is_list) {
+      if (inputs[i].is_list())
+        throw std::runtime_error("Input " + arg.name + " of " +
+                                 this->op_name + " is a single tensor");
+      TFE_OpAddInput(op.get(), inputs[i].begin()->get_eager_handle().get(),
+                     context::get_status());
+    } else {
+      small_buffer<TFE_TensorHandle*> handles(inputs[i].size());
+      size_t k = 0;
+      for (const auto& t : inputs[i])
+        handles.data()[k++] = t.get_eager_handle().get();
+      TFE_OpAddInputList(op.get(), handles.data(),
+                         static_cast<int>(handles.size()),
+                         context::get_status());
+    }
+    status_check(context::get_status());
+  }
+
+  return execute_op(op.get(), num_outputs >= 0 ? num_outputs : expected);
+}
+
+inline std::vector<tensor> execute(const std::string& op_name,
+                                   const std::vector<op_input>& inputs,
+                                   const attr_map& attrs, int num_outputs) {
+  // Prepared ops of this thread, by op name and attributes, and their
+  // keys from the most to the least recently used
+  constexpr size_t max_cached = 1024;
+  struct entry {
+    std::unique_ptr<dynamic_op> op;
+    std::list<std::string>::iterator lru;
+  };
+  thread_local std::unordered_map<std::string, entry> cache;
+  thread_local std::list<std::string> lru;
+
+  std::string key = op_name;
+  bool cacheable = true;
+  for (const auto& [name, value] : attrs) {
+    key.push_back('\0');
+    key += name;
+    cacheable = cacheable && value.append_key(&key);
+  }
+
+  // Tensor attributes are not compared, such ops are prepared every call
+  if (!cacheable)
+    return dynamic_op(op_name, attrs)(inputs, num_outputs);
+
+  auto it = cache.find(key);
+  if (it != cache.end()) {
+    lru.splice(lru.begin(), lru, it->second.lru);
+    return (*it->second.op)(inputs, num_outputs);
+  }
+
+  auto op = std::make_unique<dynamic_op>(op_name, attrs);
+  if (cache.size() >= max_cached) {
+    // The least recently used op that is not running, e.g. in a caller
+    for (auto victim = lru.end(); victim != lru.begin();) {
+      --victim;
+      auto evicted = cache.find(*victim);
+      if (!evicted->second.op->in_use()) {
+        cache.erase(evicted);
+        lru.erase(victim);
+        break;
+      }
+    }
+  }
+  lru.push_front(key);
+  it = cache.emplace(std::move(key), entry{std::move(op), lru.begin()}).first;
+  return (*it->second.op)(inputs, num_outputs);
+}
+
+}  // namespace cppflow
+
+#endif  // INCLUDE_CPPFLOW_DYNAMIC_OP_H_
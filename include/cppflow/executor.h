@@ -0,0 +1,276 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/*!
+ *  @file       executor.h
+ *  @brief      Thread pool with a bounded queue for asynchronous calls
+ */
+
+#ifndef INCLUDE_CPPFLOW_EXECUTOR_H_
+#define INCLUDE_CPPFLOW_EXECUTOR_H_
+
+// C++ headers
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cppflow {
+
+/**
+ * @class executor
+ * @brief Fixed set of worker threads fed by a bounded FIFO queue
+ *
+ * post() blocks while the queue is full, which pushes back on producers that
+ * outrun the workers; try_post() refuses the task instead. A worker never
+ * waits on its own queue: post() called from one of the workers runs the
+ * task inline when it can not be queued. The destructor runs the tasks
+ * still queued, then joins the workers.
+ */
+class executor {
+ public:
+  /**
+   * @param num_threads Number of workers, 0 for one per hardware thread
+   * @param max_queue_size Tasks that can wait for a worker, 0 for unbounded
+   */
+  explicit executor(size_t num_threads = 0, size_t max_queue_size = 1024);
+
+  executor(const executor&) = delete;
+  executor(executor&&) noexcept = default;
+
+  ~executor();
+
+  executor& operator=(const executor&) = delete;
+  executor& operator=(executor&& other) noexcept;
+
+  /**
+   * Queues a task, waiting for room if the queue is full. Called from a
+   * worker, the task runs inline instead of waiting.
+   * @param task The task, exceptions it throws are discarded
+   * @throw std::runtime_error If the executor is stopped, or stops while
+   *                           the caller waits
+   */
+  void post(std::function<void()> task);
+
+  /**
+   * Queues a task if there is room
+   * @return false if the queue was full
+   */
+  bool try_post(std::function<void()> task);
+
+  /**
+   * Queues a task even if the queue is full, e.g. the resumption of a
+   * coroutine, which can neither be refused nor wait
+   */
+  void post_unbounded(std::function<void()> task);
+
+  size_t num_threads() const;
+  size_t max_queue_size() const;
+  size_t queue_size() const;
+
+ private:
+  struct state {
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<std::function<void()>> queue;
+    size_t max_queue_size = 0;
+    bool stop = false;
+    std::vector<std::thread> workers;
+  };
+
+  static void work(state* s);
+  static void shutdown(state* s);
+  static void run(const std::function<void()>& task);
+
+  // The executor whose worker is the calling thread, if any
+  static const state*& current_worker();
+
+  std::unique_ptr<state> state_;
+};  // Class executor
+
+// Executor used by the asynchronous calls when none is given. As with
+// get_global_context(), it can be replaced before first use:
+// cppflow::get_global_executor() = cppflow::executor(4, 256);
+inline executor& get_global_executor() {
+    static executor global_executor;
+    return global_executor;
+}
+
+}  // namespace cppflow
+
+
+/******************************
+ *   IMPLEMENTATION DETAILS   *
+ ******************************/
+
+
+namespace cppflow {
+
+inline executor::executor(size_t num_threads, size_t max_queue_size)
+    : state_(std::make_unique<state>()) {
+  if (num_threads == 0)
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  state_->max_queue_size = max_queue_size;
+
+  auto s = state_.get();
+  for (size_t i = 0; i < num_threads; i++)
+    state_->workers.emplace_back([s] { work(s); });
+}
+
+inline executor::~executor() {
+  if (state_)
+    shutdown(state_.get());
+}
+
+inline executor& executor::operator=(executor&& other) noexcept {
+  if (this != &other) {
+    if (state_)
+      shutdown(state_.get());
+    state_ = std::move(other.state_);
+  }
+  return *this;
+}
+
+inline void executor::post(std::function<void()> task) {
+  if (!state_)
+    throw std::runtime_error("Posting to a moved-from executor");
+
+  const auto has_room = [this] {
+    return state_->max_queue_size == 0 ||
+           state_->queue.size() < state_->max_queue_size;
+  };
+
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  if (current_worker() == state_.get() && (state_->stop || !has_room())) {
+    // Waiting would block a worker that may be the one to make room
+    lock.unlock();
+    run(task);
+    return;
+  }
+  if (state_->stop)
+    throw std::runtime_error("Posting to a stopped executor");
+  state_->not_full.wait(lock, [&] { return state_->stop || has_room(); });
+  if (state_->stop)
+    throw std::runtime_error("Posting to a stopped executor");
+  state_->queue.push_back(std::move(task));
+  lock.unlock();
+  state_->not_empty.notify_one();
+}
+
+inline bool executor::try_post(std::function<void()> task) {
+  if (!state_)
+    throw std::runtime_error("Posting to a moved-from executor");
+
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  if (state_->stop)
+    throw std::runtime_error("Posting to a stopped executor");
+  if (state_->max_queue_size != 0 &&
+      state_->queue.size() >= state_->max_queue_size)
+    return false;
+  state_->queue.push_back(std::move(task));
+  lock.unlock();
+  state_->not_empty.notify_one();
+  return true;
+}
+
+inline void executor::post_unbounded(std::function<void()> task) {
+  if (!state_)
+    throw std::runtime_error("Posting to a moved-from executor");
+
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  if (state_->stop)
+    throw std::runtime_error("Posting to a stopped executor");
+  state_->queue.push_back(std::move(task));
+  lock.unlock();
+  state_->not_empty.notify_one();
+}
+
+inline size_t executor::num_threads() const {
+  return state_ ? state_->workers.size() : 0;
+}
+
+inline size_t executor::max_queue_size() const {
+  return state_ ? state_->max_queue_size : 0;
+}
+
+inline size_t executor::queue_size() const {
+  if (!state_)
+    return 0;
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->queue.size();
+}
+
+inline const executor::state*& executor::current_worker() {
+  thread_local const state* current = nullptr;
+  return current;
+}
+
+inline void executor::run(const std::function<void()>& task) {
+  try {
+    task();
+  } catch (...) {
+    // Tasks report their errors through their own channel (future,
+    // callback); nothing can be done with it on a worker
+  }
+}
+
+inline void executor::work(state* s) {
+  current_worker() = s;
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(s->mutex);
+      s->not_empty.wait(lock, [s] { return s->stop || !s->queue.empty(); });
+      if (s->queue.empty())
+        return;  // Stopped and drained
+      task = std::move(s->queue.front());
+      s->queue.pop_front();
+    }
+    s->not_full.notify_one();
+    run(task);
+  }
+}
+
+inline void executor::shutdown(state* s) {
+  {
+    std::lock_guard<std::mutex> lock(s->mutex);
+    s->stop = true;
+  }
+  s->not_empty.notify_all();
+  s->not_full.notify_all();
+  for (auto& t : s->workers)
+    if (t.joinable())
+      t.join();
+}
+
+}  // namespace cppflow
+
+#endif  // INCLUDE_CPPFLOW_EXECUTOR_H_
@@ -0,0 +1,516 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/*!
+ *  @file       function.h
+ *  @brief      Eager op sequences traced into a single TF_Function
+ */
+
+#ifndef INCLUDE_CPPFLOW_FUNCTION_H_
+#define INCLUDE_CPPFLOW_FUNCTION_H_
+
+// C headers
+#include <tensorflow/c/c_api.h>
+#include <tensorflow/c/eager/c_api.h>
+#include <tensorflow/c/eager/c_api_experimental.h>
+
+// C++ headers
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// CppFlow headers
+#include "cppflow/context.h"
+#include "cppflow/op_dispatch.h"
+#include "cppflow/pb_helper.h"
+#include "cppflow/tensor.h"
+
+namespace cppflow {
+
+/**
+ * @class function
+ * @brief A sequence of eager ops replayed as one op
+ *
+ * The first call with a given set of input dtypes and shapes runs the body
+ * eagerly while recording every op it executes into a TF_Graph. The graph
+ * is converted with TF_GraphToFunction and registered in the eager context,
+ * and the following calls with the same dtypes and shapes execute it as a
+ * single op. Tensors the body uses without computing them from its inputs,
+ * e.g. literals or tensor::shape() results, become constants of the
+ * function, as in tf.function. Only the ops executed on the calling thread
+ * are recorded. A function called while another one is traced is inlined
+ * into it.
+ */
+class function {
+ public:
+  using body_type =
+      std::function<std::vector<tensor>(const std::vector<tensor>&)>;
+
+  /**
+   * @param body Computes the outputs from the inputs with cppflow ops
+   * @param name Prefix of the names the traces are registered under
+   */
+  explicit function(body_type body, std::string name = "cppflow_function");
+
+  function(const function&) = delete;
+  function(function&&) = delete;
+
+  // Removes the traces from the contexts they were registered in
+  ~function();
+
+  function& operator=(const function&) = delete;
+  function& operator=(function&&) = delete;
+
+  std::vector<tensor> operator()(const std::vector<tensor>& inputs);
+
+  /**
+   * @return The number of traces, one per distinct input dtypes and shapes
+   */
+  size_t num_traces() const;
+
+ private:
+  class trace;
+
+  // A trace registered in a context
+  struct concrete {
+    concrete() = default;
+    concrete(const concrete&) = delete;
+    concrete& operator=(const concrete&) = delete;
+    ~concrete();
+
+    // Ops calling the function, reused across calls. A call takes one
+    // from the pool, or a new one if all are in use.
+    std::unique_ptr<op_slot> acquire() const;
+    void release(std::unique_ptr<op_slot> slot) const;
+
+    std::string name;
+    int num_outputs = 0;
+    uint64_t context_id = 0;
+    std::shared_ptr<TFE_Context> context;
+
+    mutable std::mutex mutex;
+    mutable std::vector<std::unique_ptr<op_slot>> idle;
+  };
+
+  // Context id, then the input dtypes, ranks and dims, flattened
+  static std::vector<int64_t> signature(const std::vector<tensor>& inputs);
+
+  body_type body;
+  std::string name;
+
+  mutable std::mutex mutex;
+  std::map<std::vector<int64_t>, std::shared_ptr<const concrete>> traces;
+};  // Class function
+
+}  // namespace cppflow
+
+
+/******************************
+ *   IMPLEMENTATION DETAILS   *
+ ******************************/
+
+
+namespace cppflow {
+
+/**
+ * @class function::trace
+ * @brief Records the ops run on this thread into a graph
+ */
+class function::trace : public op_recorder {
+ public:
+  explicit trace(const std::vector<tensor>& inputs);
+  ~trace() override { op_recorder::current() = this->previous; }
+
+  trace(const trace&) = delete;
+  trace& operator=(const trace&) = delete;
+
+  void record(TFE_Op* op, const tensor* outputs, int num_outputs) override;
+
+  /**
+   * Stops recording and builds the function
+   * @return The function computing outputs from the inputs
+   */
+  std::unique_ptr<TF_Function, decltype(&TF_DeleteFunction)> finish(
+      const std::string& fn_name, const std::vector<tensor>& outputs);
+
+ private:
+  // The graph endpoint of a handle, a new constant if it was not produced
+  // by a recorded op
+  TF_Output lookup(TFE_TensorHandle* handle);
+
+  // Names of the input args of an op, and whether each one is a list
+  const std::vector<std::pair<std::string, bool>>& input_args(
+      const std::string& op_type);
+
+  std::string unique_name(const std::string& op_type) {
+    return op_type + "_" + std::to_string(this->num_nodes++);
+  }
+
+  op_recorder* previous;
+  std::unique_ptr<TF_Graph, decltype(&TF_DeleteGraph)> graph = {
+      TF_NewGraph(), TF_DeleteGraph};
+  std::unique_ptr<TF_Status, decltype(&TF_DeleteStatus)> status = {
+      TF_NewStatus(), TF_DeleteStatus};
+  size_t num_nodes = 0;
+
+  std::vector<TF_Output> placeholders;
+  std::map<TFE_TensorHandle*, TF_Output> endpoints;
+
+  // Outputs of the recorded ops, kept alive so that their handles are not
+  // reused for other tensors while the trace runs
+  std::vector<tensor> recorded;
+
+  std::map<std::string, std::vector<std::pair<std::string, bool>>> args;
+};  // Class function::trace
+
+inline function::trace::trace(const std::vector<tensor>& inputs) {
+  for (const auto& input : inputs) {
+    auto* handle = input.get_eager_handle().get();
+    std::vector<int64_t> dims(TFE_TensorHandleNumDims(handle,
+                                                      this->status.get()));
+    status_check(this->status.get());
+    for (decltype(dims.size()) d=0; d < dims.size(); d++)
+      dims[d] = TFE_TensorHandleDim(handle, static_cast<int>(d),
+                                    this->status.get());
+    status_check(this->status.get());
+
+    auto* desc = TF_NewOperation(this->graph.get(), "Placeholder",
+                                 this->unique_name("input").c_str());
+    TF_SetAttrType(desc, "dtype", TFE_TensorHandleDataType(handle));
+    TF_SetAttrShape(desc, "shape", dims.data(), static_cast<int>(dims.size()));
+    auto* oper = TF_FinishOperation(desc, this->status.get());
+    status_check(this->status.get());
+
+    this->placeholders.push_back({oper, 0});
+    this->endpoints.emplace(handle, TF_Output{oper, 0});
+  }
+
+  this->previous = op_recorder::current();
+  op_recorder::current() = this;
+}
+
+inline const std::vector<std::pair<std::string, bool>>&
+function::trace::input_args(const std::string& op_type) {
+  auto it = this->args.find(op_type);
+  if (it != this->args.end())
+    return it->second;
+
+  std::unique_ptr<TF_Buffer, decltype(&TF_DeleteBuffer)> buf = {
+      TF_NewBuffer(), TF_DeleteBuffer};
+  TF_GraphGetOpDef(this->graph.get(), op_type.c_str(), buf.get(),
+                   this->status.get());
+  status_check(this->status.get());
+
+  // OpDef -> Field 2 is "input_arg"
+  // ArgDef -> Field 1 "name", 5 "number_attr", 6 "type_list_attr"
+  std::vector<std::pair<std::string, bool>> result;
+  ProtoReader op_def(static_cast<const uint8_t*>(buf->data), buf->length);
+  while (!op_def.eof()) {
+    uint64_t tag = op_def.read_varint();
+    if ((tag >> 3) != 2 || (tag & 7) != 2) {
+      op_def.skip(tag & 7);
+      continue;
+    }
+    std::string arg_blob = op_def.read_string();
+    ProtoReader arg(arg_blob);
+    std::pair<std::string, bool> entry = {"", false};
+    while (!arg.eof()) {
+      uint64_t arg_tag = arg.read_varint();
+      uint64_t field = arg_tag >> 3;
+      if ((arg_tag & 7) == 2 && (field == 1 || field == 5 || field == 6)) {
+        std::string value = arg.read_string();
+        if (field == 1) entry.first = std::move(value);
+        else if (!value.empty()) entry.second = true;
+      } else {
+        arg.skip(arg_tag & 7);
+      }
+    }
+    result.push_back(std::move(entry));
+  }
+  return this->args.emplace(op_type, std::move(result)).first->second;
+}
+
+inline TF_Output function::trace::lookup(TFE_TensorHandle* handle) {
+  auto it = this->endpoints.find(handle);
+  if (it != this->endpoints.end())
+    return it->second;
+
+  // Captured tensor. It is not cached: its handle may be freed and the
+  // address reused by another captured tensor.
+  std::unique_ptr<TF_Tensor, decltype(&TF_DeleteTensor)> value = {
+      TFE_TensorHandleResolve(handle, this->status.get()), TF_DeleteTensor};
+  status_check(this->status.get());
+
+  auto* desc = TF_NewOperation(this->graph.get(), "Const",
+                               this->unique_name("captured").c_str());
+  TF_SetAttrTensor(desc, "value", value.get(), this->status.get());
+  status_check(this->status.get());
+  TF_SetAttrType(desc, "dtype", TF_TensorType(value.get()));
+  auto* oper = TF_FinishOperation(desc, this->status.get());
+  status_check(this->status.get());
+  return {oper, 0};
+}
+
+inline void function::trace::record(TFE_Op* op, const tensor* outputs,
+                                    int num_outputs) {
+  const std::string op_type = TFE_OpGetName(op, this->status.get());
+  status_check(this->status.get());
+
+  // Endpoints of the inputs, in the flat order of the op
+  const int num_inputs = TFE_OpGetFlatInputCount(op, this->status.get());
+  status_check(this->status.get());
+  std::vector<TF_Output> inputs;
+  inputs.reserve(num_inputs);
+  for (int i = 0; i < num_inputs; i++) {
+    auto* handle = TFE_OpGetFlatInput(op, i, this->status.get());
+    status_check(this->status.get());
+    inputs.push_back(this->lookup(handle));
+  }
+
+  auto* desc = TF_NewOperation(this->graph.get(), op_type.c_str(),
+                               this->unique_name(op_type).c_str());
+
+  // Group the flat inputs as the OpDef does
+  size_t next = 0;
+  for (const auto& [arg_name, is_list] : this->input_args(op_type)) {
+    int length = TFE_OpGetInputLength(op, arg_name.c_str(),
+                                      this->status.get());
+    status_check(this->status.get());
+    if (next + length > inputs.size())
+      throw std::runtime_error("Unable to trace " + op_type +
+                               ": inputs do not match its definition");
+    if (is_list)
+      TF_AddInputList(desc, inputs.data() + next, length);
+    else
+      TF_AddInput(desc, inputs[next]);
+    next += length;
+  }
+
+  // NameAttrList -> Field 2 is "attr", a map<string, AttrValue>
+  std::unique_ptr<TF_Buffer, decltype(&TF_DeleteBuffer)> buf = {
+      TF_NewBuffer(), TF_DeleteBuffer};
+  TFE_OpAttrsSerialize(TFE_OpGetAttrs(op), buf.get(), this->status.get());
+  status_check(this->status.get());
+  ProtoReader attrs(static_cast<const uint8_t*>(buf->data), buf->length);
+  while (!attrs.eof()) {
+    uint64_t tag = attrs.read_varint();
+    if ((tag >> 3) != 2 || (tag & 7) != 2) {
+      attrs.skip(tag & 7);
+      continue;
+    }
+    std::string entry_blob = attrs.read_string();
+    ProtoReader entry(entry_blob);
+    std::string key, value;
+    while (!entry.eof()) {
+      uint64_t entry_tag = entry.read_varint();
+      if ((entry_tag >> 3) == 1 && (entry_tag & 7) == 2)
+        key = entry.read_string();
+      else if ((entry_tag >> 3) == 2 && (entry_tag & 7) == 2)
+        value = entry.read_string();
+      else
+        entry.skip(entry_tag & 7);
+    }
+    TF_SetAttrValueProto(desc, key.c_str(), value.data(), value.size(),
+                         this->status.get());
+    status_check(this->status.get());
+  }
+
+  auto* oper = TF_FinishOperation(desc, this->status.get());
+  status_check(this->status.get());
+
+  for (int i = 0; i < num_outputs; i++) {
+    this->endpoints[outputs[i].get_eager_handle().get()] = {oper, i};
+    this->recorded.push_back(outputs[i]);
+  }
+}
+
+inline std::unique_ptr<TF_Function, decltype(&TF_DeleteFunction)>
+function::trace::finish(const std::string& fn_name,
+                        const std::vector<tensor>& outputs) {
+  op_recorder::current() = this->previous;
+
+  // Every output goes through an Identity, so that inputs, captured
+  // tensors and repeated tensors can be returned as well
+  std::vector<TF_Output> results;
+  results.reserve(outputs.size());
+  for (const auto& output : outputs) {
+    auto source = this->lookup(output.get_eager_handle().get());
+    auto* desc = TF_NewOperation(this->graph.get(), "Identity",
+                                 this->unique_name("output").c_str());
+    TF_AddInput(desc, source);
+    auto* oper = TF_FinishOperation(desc, this->status.get());
+    status_check(this->status.get());
+    results.push_back({oper, 0});
+  }
+
+  std::unique_ptr<TF_Function, decltype(&TF_DeleteFunction)> fn = {
+      TF_GraphToFunction(this->graph.get(), fn_name.c_str(),
+                         /*append_hash_to_fn_name*/ 0, /*num_opers*/ -1,
+                         /*opers*/ nullptr,
+                         static_cast<int>(this->placeholders.size()),
+                         this->placeholders.data(),
+                         static_cast<int>(results.size()), results.data(),
+                         /*output_names*/ nullptr, /*opts*/ nullptr,
+                         /*description*/ nullptr, this->status.get()),
+      TF_DeleteFunction};
+  status_check(this->status.get());
+  return fn;
+}
+
+inline function::function(body_type body, std::string name)
+    : body(std::move(body)), name(std::move(name)) {}
+
+inline function::~function() = default;
+
+inline function::concrete::~concrete() {
+  if (!this->context)
+    return;
+
+  // The ops calling the function go first
+  this->idle.clear();
+
+  // The context is kept alive by this trace, the function can only be
+  // missing if it was removed by other means: nothing left to do then
+  std::unique_ptr<TF_Status, decltype(&TF_DeleteStatus)> status = {
+      TF_NewStatus(), TF_DeleteStatus};
+  TFE_ContextRemoveFunction(this->context.get(), this->name.c_str(),
+                            status.get());
+}
+
+inline std::unique_ptr<op_slot> function::concrete::acquire() const {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (this->idle.empty())
+    return std::make_unique<op_slot>();
+  auto slot = std::move(this->idle.back());
+  this->idle.pop_back();
+  return slot;
+}
+
+inline void function::concrete::release(std::unique_ptr<op_slot> slot) const {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->idle.push_back(std::move(slot));
+}
+
+inline std::vector<int64_t> function::signature(
+    const std::vector<tensor>& inputs) {
+  // Traces are registered in one context, a replaced global context
+  // needs its own
+  std::vector<int64_t> key = {
+      static_cast<int64_t>(context::get_context_id())};
+  for (const auto& input : inputs) {
+    auto* handle = input.get_eager_handle().get();
+    int n_dims = TFE_TensorHandleNumDims(handle, context::get_status());
+    status_check(context::get_status());
+    key.push_back(TFE_TensorHandleDataType(handle));
+    key.push_back(n_dims);
+    for (int d = 0; d < n_dims; d++)
+      key.push_back(TFE_TensorHandleDim(handle, d, context::get_status()));
+    status_check(context::get_status());
+  }
+  return key;
+}
+
+inline std::vector<tensor> function::operator()(
+    const std::vector<tensor>& inputs) {
+  // Inside another trace the body is recorded into it
+  if (op_recorder::current() != nullptr)
+    return this->body(inputs);
+
+  auto key = signature(inputs);
+  std::shared_ptr<const concrete> c;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto it = this->traces.find(key);
+    if (it != this->traces.end())
+      c = it->second;
+  }
+
+  if (c) {
+    auto slot = c->acquire();
+    std::vector<tensor> outputs;
+    {
+      cached_op op(*slot, c->name.c_str());
+      for (const auto& input : inputs) {
+        TFE_OpAddInput(op.get(), input.get_eager_handle().get(),
+                       context::get_status());
+        status_check(context::get_status());
+      }
+      outputs = execute_op(op.get(), c->num_outputs);
+    }
+    c->release(std::move(slot));
+    return outputs;
+  }
+
+  // Names are unique across functions, concurrent traces of the same
+  // signature are both registered and the first one is kept
+  static std::atomic<uint64_t> num_functions{0};
+  auto traced = std::make_shared<concrete>();
+  traced->name = this->name + "_" + std::to_string(num_functions++);
+
+  std::vector<tensor> outputs;
+  std::unique_ptr<TF_Function, decltype(&TF_DeleteFunction)> fn = {
+      nullptr, TF_DeleteFunction};
+  {
+    trace t(inputs);
+    outputs = this->body(inputs);
+    fn = t.finish(traced->name, outputs);
+  }
+  traced->num_outputs = static_cast<int>(outputs.size());
+
+  traced->context_id = context::get_context_id();
+  auto ctx = context::get_shared_context();
+  TFE_ContextAddFunction(ctx.get(), fn.get(), context::get_status());
+  status_check(context::get_status());
+  traced->context = std::move(ctx);
+
+  // A concurrent trace of the same signature may have been kept already,
+  // this one is then removed from the context by its destructor
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->traces.emplace(std::move(key), traced);
+
+  // Traces of a replaced context can not be called anymore, dropping them
+  // lets that context go
+  for (auto it = this->traces.begin(); it != this->traces.end();) {
+    if (it->second->context_id != traced->context_id)
+      it = this->traces.erase(it);
+    else
+      ++it;
+  }
+
+  // The outputs of the traced run are the result of this call
+  return outputs;
+}
+
+inline size_t function::num_traces() const {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->traces.size();
+}
+
+}  // namespace cppflow
+
+#endif  // INCLUDE_CPPFLOW_FUNCTION_H_
@@ -0,0 +1,591 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/*!
+ *  @file       graph_transform.h
+ *  @brief      Prune, strip and fold the graph of a model, then export it
+ */
+
+#ifndef INCLUDE_CPPFLOW_GRAPH_TRANSFORM_H_
+#define INCLUDE_CPPFLOW_GRAPH_TRANSFORM_H_
+
+// C headers
+#include <tensorflow/c/c_api.h>
+
+// C++ headers
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// CppFlow headers
+#include "cppflow/context.h"
+#include "cppflow/model.h"
+#include "cppflow/pb_helper.h"
+
+namespace cppflow {
+
+/**
+ * @class graph_transform
+ * @brief Rewrites a copy of a model's GraphDef for a lighter frozen graph
+ *
+ * The GraphDef is taken from model::graph and kept as a list of NodeDefs,
+ * with every field the transforms do not touch copied verbatim. Typical use:
+ *
+ *   auto r = cppflow::graph_transform(model)
+ *                .prune({"StatefulPartitionedCall:0"})
+ *                .strip()
+ *                .fold_constants()
+ *                .write("model.pb");
+ *
+ * Folding evaluates constant subgraphs, including variable reads, with the
+ * model's session, so it freezes the variables it can reach. Variables
+ * only read inside functions (TF2 StatefulPartitionedCall) are not
+ * visible to it and are kept as they are.
+ */
+class graph_transform {
+ public:
+  struct report {
+    size_t nodes_before;
+    size_t nodes_after;
+    size_t pruned;
+    size_t stripped;
+    size_t folded;
+
+    // Size of the serialized GraphDefs, and time to import them in a graph
+    size_t bytes_before;
+    size_t bytes_after;
+    double import_ms_before;
+    double import_ms_after;
+  };
+
+  /**
+   * @param m The model, its session is used to fold constants
+   */
+  explicit graph_transform(const model& m);
+
+  /**
+   * Keeps only the nodes needed to compute the fetches
+   * @param fetches Output names (e.g. "StatefulPartitionedCall:0"), they are
+   *                never stripped and are pruned to again after folding
+   */
+  graph_transform& prune(const std::vector<std::string>& fetches);
+
+  /**
+   * Removes pass-through and debug nodes: single-input ops are bypassed,
+   * ops without outputs (Assert) are removed with the control edges to them.
+   * The fetches are never removed, or without fetches the nodes nothing
+   * consumes, as they may be the outputs of the graph.
+   * @param op_types The ops to remove
+   */
+  graph_transform& strip(const std::vector<std::string>& op_types = {
+      "Identity", "CheckNumerics", "Assert"});
+
+  /**
+   * Replaces the outputs of constant subgraphs by Const nodes
+   * A subgraph is constant if it only has pure ops and variable reads, and
+   * no placeholder. Only its outputs consumed by the rest of the graph are
+   * evaluated.
+   * @param max_bytes Larger outputs are not folded, 0 for no limit
+   */
+  graph_transform& fold_constants(size_t max_bytes = 0);
+
+  size_t num_nodes() const { return nodes.size(); }
+
+  /**
+   * @return The serialized GraphDef
+   */
+  std::string graph_def() const;
+
+  /**
+   * Imports the result into a new graph, exports it with TF_GraphToGraphDef
+   * and writes it to a file, loadable as model::FROZEN_GRAPH
+   * @return Node counts, sizes and import times before and after
+   */
+  report write(const std::string& filename) const;
+
+ private:
+  struct node {
+    std::string name;
+    std::string op;
+    std::vector<std::string> inputs;  // "x", "x:1" or "^x" for control
+    std::string rest;                 // Other NodeDef fields, encoded
+  };
+
+  static node parse_node(const std::string& blob);
+  static std::string serialize_node(const node& n);
+
+  // "^x" -> "x", "x:1" -> "x"
+  static std::string node_name(const std::string& input);
+  static bool is_control(const std::string& input) {
+    return !input.empty() && input[0] == '^';
+  }
+
+  static double import_ms(const std::string& graph_def, std::string* exported);
+  void prune_to_fetches();
+
+  std::shared_ptr<TF_Graph> graph;
+  std::shared_ptr<TF_Session> session;
+
+  std::vector<node> nodes;
+  std::string rest;  // Other GraphDef fields (library, versions), encoded
+  std::vector<std::string> fetches;
+
+  std::string original;
+  size_t original_nodes = 0;
+  size_t pruned = 0;
+  size_t stripped = 0;
+  size_t folded = 0;
+};  // Class graph_transform
+
+}  // namespace cppflow
+
+
+/******************************
+ *   IMPLEMENTATION DETAILS   *
+ ******************************/
+
+
+namespace cppflow {
+
+inline graph_transform::graph_transform(const model& m)
+    : graph(m.graph), session(m.session) {
+  std::unique_ptr<TF_Buffer, decltype(&TF_DeleteBuffer)> buffer = {
+      TF_NewBuffer(), TF_DeleteBuffer};
+  TF_GraphToGraphDef(this->graph.get(), buffer.get(), context::get_status());
+  status_check(context::get_status());
+  this->original.assign(static_cast<const char*>(buffer->data),
+                        buffer->length);
+
+  // GraphDef -> Field 1 is "repeated NodeDef node"
+  ProtoReader reader(this->original);
+  while (!reader.eof()) {
+    const uint8_t* start = reader.position();
+    uint64_t tag = reader.read_varint();
+    if ((tag >> 3) == 1 && (tag & 7) == 2) {
+      std::string node_blob = reader.read_string();
+      this->nodes.push_back(parse_node(node_blob));
+    } else {
+      reader.skip(tag & 7);
+      this->rest.append(reinterpret_cast<const char*>(start),
+                        reader.position() - start);
+    }
+  }
+  this->original_nodes = this->nodes.size();
+}
+
+inline graph_transform::node graph_transform::parse_node(
+    const std::string& blob) {
+  // NodeDef -> Field 1 is "name", Field 2 is "op", Field 3 is "repeated input"
+  node n;
+  ProtoReader reader(blob);
+  while (!reader.eof()) {
+    const uint8_t* start = reader.position();
+    uint64_t tag = reader.read_varint();
+    uint64_t field = tag >> 3;
+    if (field >= 1 && field <= 3 && (tag & 7) == 2) {
+      std::string value = reader.read_string();
+      if (field == 1) n.name = std::move(value);
+      else if (field == 2) n.op = std::move(value);
+      else n.inputs.push_back(std::move(value));
+    } else {
+      reader.skip(tag & 7);
+      n.rest.append(reinterpret_cast<const char*>(start),
+                    reader.position() - start);
+    }
+  }
+  return n;
+}
+
+inline std::string graph_transform::serialize_node(const node& n) {
+  ProtoWriter writer;
+  writer.write_string(1, n.name);
+  writer.write_string(2, n.op);
+  for (const auto& input : n.inputs)
+    writer.write_string(3, input);
+  writer.write_raw(n.rest);
+  const auto& data = writer.data();
+  return std::string(data.begin(), data.end());
+}
+
+inline std::string graph_transform::node_name(const std::string& input) {
+  size_t begin = is_control(input) ? 1 : 0;
+  size_t colon = input.find(':', begin);
+  return input.substr(begin, colon == std::string::npos ?
+                                 std::string::npos : colon - begin);
+}
+
+inline std::string graph_transform::graph_def() const {
+  ProtoWriter writer;
+  for (const auto& n : this->nodes)
+    writer.write_string(1, serialize_node(n));
+  writer.write_raw(this->rest);
+  const auto& data = writer.data();
+  return std::string(data.begin(), data.end());
+}
+
+inline graph_transform& graph_transform::prune(
+    const std::vector<std::string>& fetches) {
+  if (fetches.empty())
+    throw std::runtime_error("Pruning needs at least one fetch");
+  this->fetches = fetches;
+  this->prune_to_fetches();
+  return *this;
+}
+
+inline void graph_transform::prune_to_fetches() {
+  std::map<std::string, size_t> index;
+  for (size_t i = 0; i < this->nodes.size(); i++)
+    index[this->nodes[i].name] = i;
+
+  std::vector<bool> keep(this->nodes.size(), false);
+  std::vector<size_t> stack;
+  for (const auto& fetch : this->fetches) {
+    auto it = index.find(node_name(fetch));
+    if (it == index.end())
+      throw std::runtime_error("No operation named \"" + node_name(fetch) +
+                               "\" exists");
+    stack.push_back(it->second);
+  }
+  while (!stack.empty()) {
+    size_t i = stack.back();
+    stack.pop_back();
+    if (keep[i])
+      continue;
+    keep[i] = true;
+    for (const auto& input : this->nodes[i].inputs) {
+      auto it = index.find(node_name(input));
+      if (it != index.end() && !keep[it->second])
+        stack.push_back(it->second);
+    }
+  }
+
+  std::vector<node> kept;
+  for (size_t i = 0; i < this->nodes.size(); i++)
+    if (keep[i])
+      kept.push_back(std::move(this->nodes[i]));
+  this->pruned += this->nodes.size() - kept.size();
+  this->nodes = std::move(kept);
+}
+
+inline graph_transform& graph_transform::strip(
+    const std::vector<std::string>& op_types) {
+  const std::set<std::string> types(op_types.begin(), op_types.end());
+  std::set<std::string> protected_nodes;
+  for (const auto& fetch : this->fetches)
+    protected_nodes.insert(node_name(fetch));
+
+  // Without fetches the outputs are not known: the nodes nothing consumes,
+  // e.g. the "Identity" outputs of a frozen TF2 graph, are kept by name
+  if (this->fetches.empty()) {
+    std::set<std::string> consumed;
+    for (const auto& n : this->nodes)
+      for (const auto& input : n.inputs)
+        consumed.insert(node_name(input));
+    for (const auto& n : this->nodes)
+      if (!consumed.count(n.name))
+        protected_nodes.insert(n.name);
+  }
+
+  // Bypassing the outputs of control flow ops would change which branch
+  // or frame their consumers belong to
+  static const std::set<std::string> control_flow = {
+      "Switch", "Merge", "Enter", "Exit", "NextIteration", "LoopCond"};
+
+  std::map<std::string, const node*> by_name;
+  for (const auto& n : this->nodes)
+    by_name[n.name] = &n;
+
+  std::map<std::string, std::string> bypass;  // Removed node -> its input
+  std::set<std::string> removed;
+  for (const auto& n : this->nodes) {
+    if (!types.count(n.op) || protected_nodes.count(n.name))
+      continue;
+
+    size_t data_inputs = 0;
+    bool control_inputs = false;
+    for (const auto& input : n.inputs) {
+      if (is_control(input)) control_inputs = true;
+      else data_inputs++;
+    }
+
+    if (n.op == "Assert") {
+      // No outputs, only referred to by control edges
+      removed.insert(n.name);
+    } else if (data_inputs == 1 && !control_inputs) {
+      auto producer = by_name.find(node_name(n.inputs[0]));
+      if (producer != by_name.end() &&
+          control_flow.count(producer->second->op))
+        continue;
+      bypass[n.name] = n.inputs[0];
+      removed.insert(n.name);
+    }
+  }
+  if (removed.empty())
+    return *this;
+
+  auto resolve = [&](std::string input) {
+    for (auto it = bypass.find(node_name(input)); it != bypass.end();
+         it = bypass.find(node_name(input))) {
+      // Only output 0 passes through
+      auto colon = input.find(':');
+      if (!is_control(input) && colon != std::string::npos &&
+          input.substr(colon + 1) != "0")
+        break;
+      input = is_control(input) ? "^" + node_name(it->second) : it->second;
+    }
+    return input;
+  };
+
+  std::vector<node> kept;
+  for (auto& n : this->nodes) {
+    if (removed.count(n.name))
+      continue;
+
+    std::vector<std::string> inputs;
+    std::set<std::string> controls;
+    for (const auto& input : n.inputs) {
+      if (is_control(input) && removed.count(node_name(input)) &&
+          !bypass.count(node_name(input)))
+        continue;  // Edge to an Assert
+      auto resolved = resolve(input);
+      if (is_control(resolved) && !controls.insert(resolved).second)
+        continue;
+      inputs.push_back(std::move(resolved));
+    }
+    n.inputs = std::move(inputs);
+    kept.push_back(std::move(n));
+  }
+  this->stripped += this->nodes.size() - kept.size();
+  this->nodes = std::move(kept);
+  return *this;
+}
+
+inline graph_transform& graph_transform::fold_constants(size_t max_bytes) {
+  // Ops whose outputs only depend on their inputs, or on variables that
+  // are fixed once the model is loaded
+  static const std::set<std::string> pure_ops = {
+      "Const", "Identity", "VarHandleOp", "ReadVariableOp", "VariableV2",
+      "Variable", "Add", "AddV2", "AddN", "Sub", "Mul", "RealDiv", "Div",
+      "FloorDiv", "FloorMod", "Maximum", "Minimum", "Neg", "Abs", "Sqrt",
+      "Rsqrt", "Square", "Exp", "Log", "Reciprocal", "Cast", "Reshape",
+      "Transpose", "ExpandDims", "Squeeze", "Pack", "ConcatV2", "Fill",
+      "Tile", "Pad", "MatMul", "BiasAdd", "Shape", "Range", "StridedSlice",
+      "Slice", "GatherV2", "Relu", "Relu6", "Sigmoid", "Tanh", "Sum", "Mean",
+      "Prod", "Max", "Min", "ZerosLike", "OnesLike", "Select", "SelectV2",
+      "Equal", "NotEqual", "Greater", "GreaterEqual", "Less", "LessEqual",
+      "LogicalAnd", "LogicalOr", "LogicalNot", "BroadcastTo"};
+
+  const size_t n = this->nodes.size();
+  std::map<std::string, size_t> index;
+  for (size_t i = 0; i < n; i++)
+    index[this->nodes[i].name] = i;
+
+  // Constant-valued nodes, by an iterative depth-first search. Nodes on a
+  // cycle (loops) are not constant.
+  enum { UNVISITED, VISITING, DONE };
+  std::vector<int> state(n, UNVISITED);
+  std::vector<bool> constant(n, false);
+  for (size_t root = 0; root < n; root++) {
+    if (state[root] != UNVISITED)
+      continue;
+    std::vector<std::pair<size_t, size_t>> stack = {{root, 0}};
+    state[root] = VISITING;
+    while (!stack.empty()) {
+      auto& [i, next] = stack.back();
+      const auto& inputs = this->nodes[i].inputs;
+      if (next < inputs.size()) {
+        auto it = index.find(node_name(inputs[next++]));
+        if (it != index.end() && state[it->second] == UNVISITED) {
+          state[it->second] = VISITING;
+          stack.emplace_back(it->second, 0);
+        }
+        continue;
+      }
+
+      bool c = pure_ops.count(this->nodes[i].op) > 0;
+      for (const auto& input : inputs) {
+        auto it = index.find(node_name(input));
+        c = c && it != index.end() && state[it->second] == DONE &&
+            constant[it->second];
+      }
+      constant[i] = c;
+      state[i] = DONE;
+      stack.pop_back();
+    }
+  }
+
+  // Nodes whose value is needed by a non-constant node or is fetched
+  std::vector<bool> needed(n, false);
+  for (size_t i = 0; i < n; i++) {
+    if (constant[i])
+      continue;
+    for (const auto& input : this->nodes[i].inputs) {
+      auto it = index.find(node_name(input));
+      if (!is_control(input) && it != index.end())
+        needed[it->second] = true;
+    }
+  }
+  for (const auto& fetch : this->fetches) {
+    auto it = index.find(node_name(fetch));
+    if (it != index.end())
+      needed[it->second] = true;
+  }
+
+  std::vector<size_t> frontier;
+  std::vector<TF_Output> outputs;
+  for (size_t i = 0; i < n; i++) {
+    if (!constant[i] || !needed[i] || this->nodes[i].op == "Const")
+      continue;
+    TF_Operation* op = TF_GraphOperationByName(this->graph.get(),
+                                               this->nodes[i].name.c_str());
+    if (op == nullptr || TF_OperationNumOutputs(op) != 1)
+      continue;
+    // Only plain dtypes can be written as tensor_content; reference types
+    // are above 100
+    auto dtype = TF_OperationOutputType({op, 0});
+    if (dtype == TF_STRING || dtype == TF_RESOURCE || dtype == TF_VARIANT ||
+        static_cast<int>(dtype) > 100)
+      continue;
+    frontier.push_back(i);
+    outputs.push_back({op, 0});
+  }
+
+  // Evaluate in chunks, to bound the memory of the fetched values
+  constexpr size_t chunk = 64;
+  for (size_t begin = 0; begin < frontier.size(); begin += chunk) {
+    const size_t count = std::min(chunk, frontier.size() - begin);
+    std::vector<TF_Tensor*> values(count, nullptr);
+    TF_SessionRun(this->session.get(), nullptr, nullptr, nullptr, 0,
+                  outputs.data() + begin, values.data(),
+                  static_cast<int>(count), nullptr, 0, nullptr,
+                  context::get_status());
+    status_check(context::get_status());
+
+    for (size_t k = 0; k < count; k++) {
+      std::unique_ptr<TF_Tensor, decltype(&TF_DeleteTensor)> value = {
+          values[k], TF_DeleteTensor};
+      const size_t bytes = TF_TensorByteSize(value.get());
+      if (max_bytes > 0 && bytes > max_bytes)
+        continue;
+
+      // TensorProto -> Field 1 is "dtype", Field 2 is "tensor_shape",
+      // Field 4 is "tensor_content"
+      ProtoWriter shape;
+      for (int d = 0; d < TF_NumDims(value.get()); d++) {
+        ProtoWriter dim;
+        dim.write_int(1, TF_Dim(value.get(), d));
+        shape.write_message(2, dim);
+      }
+      ProtoWriter tensor_proto;
+      tensor_proto.write_int(1, TF_TensorType(value.get()));
+      tensor_proto.write_message(2, shape);
+      tensor_proto.write_bytes(4, TF_TensorData(value.get()), bytes);
+
+      // NodeDef -> Field 5 is "map<string, AttrValue> attr"
+      // AttrValue -> Field 6 is "type", Field 8 is "tensor"
+      ProtoWriter dtype_attr, value_attr, dtype_entry, value_entry, attrs;
+      dtype_attr.write_int(6, TF_TensorType(value.get()));
+      dtype_entry.write_string(1, "dtype");
+      dtype_entry.write_message(2, dtype_attr);
+      value_attr.write_message(8, tensor_proto);
+      value_entry.write_string(1, "value");
+      value_entry.write_message(2, value_attr);
+      attrs.write_message(5, dtype_entry);
+      attrs.write_message(5, value_entry);
+
+      auto& folded_node = this->nodes[frontier[begin + k]];
+      folded_node.op = "Const";
+      folded_node.inputs.clear();
+      folded_node.rest.assign(attrs.data().begin(), attrs.data().end());
+      this->folded++;
+    }
+  }
+
+  // The subgraphs behind the folded nodes are no longer used
+  if (!this->fetches.empty())
+    this->prune_to_fetches();
+  return *this;
+}
+
+inline double graph_transform::import_ms(const std::string& graph_def,
+                                         std::string* exported) {
+  std::unique_ptr<TF_Graph, decltype(&TF_DeleteGraph)> graph = {
+      TF_NewGraph(), TF_DeleteGraph};
+  std::unique_ptr<TF_Buffer, decltype(&TF_DeleteBuffer)> buffer = {
+      TF_NewBufferFromString(graph_def.data(), graph_def.size()),
+      TF_DeleteBuffer};
+  std::unique_ptr<TF_ImportGraphDefOptions,
+                  decltype(&TF_DeleteImportGraphDefOptions)> options = {
+      TF_NewImportGraphDefOptions(), TF_DeleteImportGraphDefOptions};
+
+  auto start = std::chrono::steady_clock::now();
+  TF_GraphImportGraphDef(graph.get(), buffer.get(), options.get(),
+                         context::get_status());
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  status_check(context::get_status());
+
+  if (exported != nullptr) {
+    std::unique_ptr<TF_Buffer, decltype(&TF_DeleteBuffer)> out = {
+        TF_NewBuffer(), TF_DeleteBuffer};
+    TF_GraphToGraphDef(graph.get(), out.get(), context::get_status());
+    status_check(context::get_status());
+    exported->assign(static_cast<const char*>(out->data), out->length);
+  }
+  return elapsed.count();
+}
+
+inline graph_transform::report graph_transform::write(
+    const std::string& filename) const {
+  report r;
+  r.nodes_before = this->original_nodes;
+  r.nodes_after = this->nodes.size();
+  r.pruned = this->pruned;
+  r.stripped = this->stripped;
+  r.folded = this->folded;
+
+  std::string exported;
+  r.import_ms_before = import_ms(this->original, nullptr);
+  r.import_ms_after = import_ms(this->graph_def(), &exported);
+  r.bytes_before = this->original.size();
+  r.bytes_after = exported.size();
+
+  std::ofstream file(filename, std::ios::binary);
+  file.write(exported.data(), static_cast<std::streamsize>(exported.size()));
+  file.close();
+  if (file.fail())
+    throw std::runtime_error("Unable to write " + filename);
+  return r;
+}
+
+}  // namespace cppflow
+
+#endif  // INCLUDE_CPPFLOW_GRAPH_TRANSFORM_H_
@@ -0,0 +1,428 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/*!
+ *  @file       metrics.h
+ *  @brief      Latency histograms and counters of model calls
+ */
+
+#ifndef INCLUDE_CPPFLOW_METRICS_H_
+#define INCLUDE_CPPFLOW_METRICS_H_
+
+// C headers
+#include <tensorflow/c/c_api.h>
+
+// C++ headers
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace cppflow {
+
+/**
+ * @class latency_histogram
+ * @brief Lock-free log-linear histogram of durations
+ *
+ * Every power of two of nanoseconds is split into sub_buckets linear
+ * buckets, as in HdrHistogram, so a recorded value is known to within
+ * 1/sub_buckets of itself. Values from 1 ns to max_seconds() are kept,
+ * longer ones are counted in the last bucket. Recording is a few relaxed
+ * atomic increments and never blocks.
+ */
+class latency_histogram {
+ public:
+  static constexpr int sub_bucket_bits = 4;
+  static constexpr size_t sub_buckets = size_t(1) << sub_bucket_bits;
+
+  // Values up to 2^40 ns, about 18 minutes
+  static constexpr int max_value_bits = 40;
+  static constexpr size_t num_buckets =
+      (max_value_bits - sub_bucket_bits + 1) * sub_buckets;
+
+  struct snapshot {
+    // Per-bucket counts, see bucket_upper_seconds()
+    std::vector<uint64_t> buckets;
+
+    uint64_t count = 0;
+    double sum_seconds = 0;
+    double max_seconds = 0;
+
+    double mean_seconds() const {
+      return count > 0 ? sum_seconds / static_cast<double>(count) : 0.0;
+    }
+
+    /**
+     * @param q Quantile in [0, 1], e.g. 0.99
+     * @return Upper bound of the bucket holding the quantile, at most the
+     *         largest recorded value
+     */
+    double percentile(double q) const;
+  };
+
+  latency_histogram() = default;
+  latency_histogram(const latency_histogram&) = delete;
+  latency_histogram& operator=(const latency_histogram&) = delete;
+
+  void record(std::chrono::nanoseconds duration);
+
+  /**
+   * Reads the counts. Values recorded concurrently may or may not be
+   * included, count always equals the sum of the buckets.
+   */
+  snapshot read() const;
+
+  void reset();
+
+  static size_t bucket_index(uint64_t ns);
+
+  /**
+   * @return The largest duration in bucket i, in seconds
+   */
+  static double bucket_upper_seconds(size_t i);
+  static double max_seconds() { return bucket_upper_seconds(num_buckets - 1); }
+
+ private:
+  std::array<std::atomic<uint64_t>, num_buckets> buckets_{};
+  std::atomic<uint64_t> sum_ns_{0};
+  std::atomic<uint64_t> max_ns_{0};
+};  // Class latency_histogram
+
+/**
+ * @class model_metrics
+ * @brief Per-model instrumentation of every session run
+ *
+ * A call is split in three stages: input marshalling (name lookup and
+ * checks of the inputs), the TF_SessionRun itself, and output wrapping
+ * into cppflow::tensor. The whole call is also recorded as total. Copies
+ * of a model, and the calls prepared from it, share one model_metrics.
+ */
+class model_metrics {
+ public:
+  enum class stage { input = 0, run, output, total };
+  static constexpr size_t num_stages = 4;
+
+  struct snapshot {
+    // Calls started, calls that threw, and calls that hit their deadline
+    // (also counted in errors)
+    uint64_t calls = 0;
+    uint64_t errors = 0;
+    uint64_t timeouts = 0;
+
+    // Calls started and not yet returned
+    int64_t in_flight = 0;
+
+    // Indexed by stage, total only covers successful calls
+    std::array<latency_histogram::snapshot, num_stages> stages;
+
+    const latency_histogram::snapshot& operator[](stage s) const {
+      return stages[static_cast<size_t>(s)];
+    }
+  };
+
+  /**
+   * @class call_scope
+   * @brief Times one call, counts it as an error unless done() is reached
+   */
+  class call_scope {
+   public:
+    // metrics may be null, the scope then records nothing
+    explicit call_scope(model_metrics* metrics);
+    ~call_scope();
+
+    call_scope(const call_scope&) = delete;
+    call_scope& operator=(const call_scope&) = delete;
+
+    // Records the time since the previous mark as stage s
+    void mark(stage s);
+
+    // Marks the run stage and notes whether the run hit its deadline
+    void ran(const TF_Status* status);
+
+    void done() { this->ok = true; }
+
+   private:
+    model_metrics* metrics;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point last;
+    bool ok = false;
+    bool timed_out = false;
+  };
+
+  model_metrics() = default;
+  model_metrics(const model_metrics&) = delete;
+  model_metrics& operator=(const model_metrics&) = delete;
+
+  snapshot read() const;
+
+  // Not atomic with calls in flight, which may land on either side
+  void reset();
+
+  // A call that expired before it started, e.g. in an executor queue
+  void record_expired();
+
+ private:
+  std::array<latency_histogram, num_stages> stages_;
+  std::atomic<uint64_t> calls_{0};
+  std::atomic<uint64_t> errors_{0};
+  std::atomic<uint64_t> timeouts_{0};
+  std::atomic<int64_t> in_flight_{0};
+};  // Class model_metrics
+
+/**
+ * Writes the metrics in the Prometheus text exposition format
+ * @param model_label Value of the "model" label of every sample
+ * @param prefix Prefix of the metric names
+ */
+void write_prometheus(std::ostream& out, const model_metrics::snapshot& s,
+                      const std::string& model_label,
+                      const std::string& prefix = "cppflow_model");
+
+std::string to_prometheus(const model_metrics::snapshot& s,
+                          const std::string& model_label,
+                          const std::string& prefix = "cppflow_model");
+
+}  // namespace cppflow
+
+
+/******************************
+ *   IMPLEMENTATION DETAILS   *
+ ******************************/
+
+
+namespace cppflow {
+
+inline size_t latency_histogram::bucket_index(uint64_t ns) {
+  if (ns < sub_buckets)
+    return static_cast<size_t>(ns);
+
+  int msb = 63;
+  while (!(ns >> msb)) msb--;
+  if (msb >= max_value_bits)
+    return num_buckets - 1;
+
+  // The top sub_bucket_bits + 1 bits select the bucket
+  const int shift = msb - sub_bucket_bits;
+  return static_cast<size_t>(shift) * sub_buckets +
+         static_cast<size_t>(ns >> shift);
+}
+
+inline double latency_histogram::bucket_upper_seconds(size_t i) {
+  uint64_t upper;
+  if (i < sub_buckets) {
+    upper = i;
+  } else {
+    const int shift = static_cast<int>(i / sub_buckets) - 1;
+    const uint64_t top = i % sub_buckets + sub_buckets;
+    upper = ((top + 1) << shift) - 1;
+  }
+  return static_cast<double>(upper) * 1e-9;
+}
+
+inline void latency_histogram::record(std::chrono::nanoseconds duration) {
+  const uint64_t ns = duration.count() > 0 ?
+                      static_cast<uint64_t>(duration.count()) : 0;
+  this->buckets_[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+  this->sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+
+  uint64_t max = this->max_ns_.load(std::memory_order_relaxed);
+  while (ns > max && !this->max_ns_.compare_exchange_weak(
+                         max, ns, std::memory_order_relaxed)) {}
+}
+
+inline latency_histogram::snapshot latency_histogram::read() const {
+  snapshot s;
+  s.buckets.resize(num_buckets);
+  for (size_t i = 0; i < num_buckets; i++) {
+    s.buckets[i] = this->buckets_[i].load(std::memory_order_relaxed);
+    s.count += s.buckets[i];
+  }
+  s.sum_seconds = static_cast<double>(
+      this->sum_ns_.load(std::memory_order_relaxed)) * 1e-9;
+  s.max_seconds = static_cast<double>(
+      this->max_ns_.load(std::memory_order_relaxed)) * 1e-9;
+  return s;
+}
+
+inline void latency_histogram::reset() {
+  for (auto& b : this->buckets_)
+    b.store(0, std::memory_order_relaxed);
+  this->sum_ns_.store(0, std::memory_order_relaxed);
+  this->max_ns_.store(0, std::memory_order_relaxed);
+}
+
+inline double latency_histogram::snapshot::percentile(double q) const {
+  if (this->count == 0)
+    return 0.0;
+
+  q = q < 0.0 ? 0.0 : (q > 1.0 ? 1.0 : q);
+  uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(this->count));
+  if (rank == 0) rank = 1;
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < this->buckets.size(); i++) {
+    seen += this->buckets[i];
+    if (seen >= rank) {
+      double upper = latency_histogram::bucket_upper_seconds(i);
+      return upper < this->max_seconds ? upper : this->max_seconds;
+    }
+  }
+  return this->max_seconds;
+}
+
+inline model_metrics::call_scope::call_scope(model_metrics* metrics)
+    : metrics(metrics) {
+  if (!this->metrics)
+    return;
+  this->metrics->calls_.fetch_add(1, std::memory_order_relaxed);
+  this->metrics->in_flight_.fetch_add(1, std::memory_order_relaxed);
+  this->start = this->last = std::chrono::steady_clock::now();
+}
+
+inline model_metrics::call_scope::~call_scope() {
+  if (!this->metrics)
+    return;
+  if (this->ok) {
+    this->metrics->stages_[static_cast<size_t>(stage::total)].record(
+        std::chrono::steady_clock::now() - this->start);
+  } else {
+    this->metrics->errors_.fetch_add(1, std::memory_order_relaxed);
+    if (this->timed_out)
+      this->metrics->timeouts_.fetch_add(1, std::memory_order_relaxed);
+  }
+  this->metrics->in_flight_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+inline void model_metrics::call_scope::mark(stage s) {
+  if (!this->metrics)
+    return;
+  auto now = std::chrono::steady_clock::now();
+  this->metrics->stages_[static_cast<size_t>(s)].record(now - this->last);
+  this->last = now;
+}
+
+inline void model_metrics::call_scope::ran(const TF_Status* status) {
+  this->mark(stage::run);
+  this->timed_out = TF_GetCode(status) == TF_DEADLINE_EXCEEDED;
+}
+
+inline model_metrics::snapshot model_metrics::read() const {
+  snapshot s;
+  s.calls = this->calls_.load(std::memory_order_relaxed);
+  s.errors = this->errors_.load(std::memory_order_relaxed);
+  s.timeouts = this->timeouts_.load(std::memory_order_relaxed);
+  s.in_flight = this->in_flight_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < num_stages; i++)
+    s.stages[i] = this->stages_[i].read();
+  return s;
+}
+
+inline void model_metrics::reset() {
+  this->calls_.store(0, std::memory_order_relaxed);
+  this->errors_.store(0, std::memory_order_relaxed);
+  this->timeouts_.store(0, std::memory_order_relaxed);
+  for (auto& h : this->stages_)
+    h.reset();
+}
+
+inline void model_metrics::record_expired() {
+  this->errors_.fetch_add(1, std::memory_order_relaxed);
+  this->timeouts_.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void write_prometheus(std::ostream& out,
+                             const model_metrics::snapshot& s,
+                             const std::string& model_label,
+                             const std::string& prefix) {
+  // Label values escape backslashes, quotes and newlines
+  std::string label = "model=\"";
+  for (char c : model_label) {
+    if (c == '\\' || c == '"') label += '\\';
+    if (c == '\n') { label += "\\n"; continue; }
+    label += c;
+  }
+  label += "\"";
+
+  auto scalar = [&](const std::string& name, const char* type,
+                    const char* help, auto value) {
+    out << "# HELP " << prefix << name << " " << help << "\n"
+        << "# TYPE " << prefix << name << " " << type << "\n"
+        << prefix << name << "{" << label << "} " << value << "\n";
+  };
+  scalar("_calls_total", "counter", "Model calls started.",
+         s.calls);
+  scalar("_errors_total", "counter", "Model calls that failed.",
+         s.errors);
+  scalar("_timeouts_total", "counter", "Model calls past their deadline.",
+         s.timeouts);
+  scalar("_in_flight", "gauge", "Model calls in progress.",
+         s.in_flight);
+
+  // The fine buckets are folded into coarse cumulative ones. A fine
+  // bucket counts towards le only if it lies entirely below it.
+  static const double bounds[] = {
+      1e-5, 2.5e-5, 5e-5, 1e-4, 2.5e-4, 5e-4, 1e-3, 2.5e-3, 5e-3,
+      1e-2, 2.5e-2, 5e-2, 0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+  static const char* stage_names[] = {"input", "run", "output", "total"};
+
+  // Enough digits for nanoseconds summed over long uptimes
+  const auto precision = out.precision(15);
+  const std::string name = prefix + "_stage_seconds";
+  out << "# HELP " << name << " Latency of the stages of a model call.\n"
+      << "# TYPE " << name << " histogram\n";
+  for (size_t st = 0; st < model_metrics::num_stages; st++) {
+    const auto& h = s.stages[st];
+    const std::string labels = label + ",stage=\"" + stage_names[st] + "\"";
+
+    size_t i = 0;
+    uint64_t cumulative = 0;
+    for (double le : bounds) {
+      for (; i < h.buckets.size() &&
+             latency_histogram::bucket_upper_seconds(i) <= le; i++)
+        cumulative += h.buckets[i];
+      out << name << "_bucket{" << labels << ",le=\"" << le << "\"} "
+          << cumulative << "\n";
+    }
+    out << name << "_bucket{" << labels << ",le=\"+Inf\"} " << h.count
+        << "\n"
+        << name << "_sum{" << labels << "} " << h.sum_seconds << "\n"
+        << name << "_count{" << labels << "} " << h.count << "\n";
+  }
+  out.precision(precision);
+}
+
+inline std::string to_prometheus(const model_metrics::snapshot& s,
+                                 const std::string& model_label,
+                                 const std::string& prefix) {
+  std::ostringstream out;
+  write_prometheus(out, s, model_label, prefix);
+  return out.str();
+}
+
+}  // namespace cppflow
+
+#endif  // INCLUDE_CPPFLOW_METRICS_H_
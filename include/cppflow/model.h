@@ -40,12 +40,49 @@
 #define INCLUDE_CPPFLOW_MODEL_H_
 
 // C headers
+#if defined(_WIN32)
+// Only the file mapping API is needed: keep out the rarely used headers and
+// the min/max macros, without leaving the defines to the includer
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#define CPPFLOW_UNDEF_WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#define CPPFLOW_UNDEF_NOMINMAX
+#endif
+#include <windows.h>
+#ifdef CPPFLOW_UNDEF_WIN32_LEAN_AND_MEAN
+#undef WIN32_LEAN_AND_MEAN
+#undef CPPFLOW_UNDEF_WIN32_LEAN_AND_MEAN
+#endif
+#ifdef CPPFLOW_UNDEF_NOMINMAX
+#undef NOMINMAX
+#undef CPPFLOW_UNDEF_NOMINMAX
+#endif
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
 #include <tensorflow/c/c_api.h>
 
 // C++ headers
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <numeric>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -53,22 +90,63 @@
 // CppFlow headers
 #include "cppflow/context.h"
 #include "cppflow/defer.h"
+#include "cppflow/executor.h"
+#include "cppflow/metrics.h"
 #include "cppflow/tensor.h"
 #include "cppflow/pb_helper.h"
+#include "cppflow/tracer.h"
 
 namespace cppflow {
+  /**
+   * Runs a session step, with a full trace when the tracer samples it
+   * @param tracer May be null
+   * @param timeout_in_ms Cancels the step after this long, 0 for no limit
+   */
+  inline void session_run(TF_Session* session, run_tracer* tracer,
+                          const TF_Output* inputs, TF_Tensor* const* input_values,
+                          int ninputs, const TF_Output* outputs,
+                          TF_Tensor** output_values, int noutputs,
+                          TF_Status* status, int64_t timeout_in_ms = 0) {
+    const bool trace = tracer != nullptr && tracer->should_trace();
+    if (!trace && timeout_in_ms <= 0) {
+      TF_SessionRun(session, /*run_options*/ NULL,
+                    inputs, input_values, ninputs,
+                    outputs, output_values, noutputs,
+                    /*targets*/ NULL, /*ntargets*/ 0, /*run_metadata*/ NULL,
+                    status);
+      return;
+    }
+
+    // RunOptions -> Field 2 is "timeout_in_ms"
+    ProtoWriter options(trace ? run_tracer::run_options() :
+                                std::vector<uint8_t>{});
+    if (timeout_in_ms > 0)
+      options.write_int(2, timeout_in_ms);
+
+    std::unique_ptr<TF_Buffer, decltype(&TF_DeleteBuffer)> run_options = {
+        TF_NewBufferFromString(options.data().data(), options.data().size()),
+        TF_DeleteBuffer};
+    std::unique_ptr<TF_Buffer, decltype(&TF_DeleteBuffer)> run_metadata = {
+        trace ? TF_NewBuffer() : nullptr, TF_DeleteBuffer};
+
+    TF_SessionRun(session, run_options.get(),
+                  inputs, input_values, ninputs,
+                  outputs, output_values, noutputs,
+                  /*targets*/ NULL, /*ntargets*/ 0, run_metadata.get(),
+                  status);
+
+    if (trace && TF_GetCode(status) == TF_OK &&
+        run_metadata->data != nullptr) {
+      tracer->record(std::string(static_cast<const char*>(run_metadata->data),
+                                 run_metadata->length));
+    }
+  }
+
   inline void setup_SessionOptions(TF_SessionOptions* options, const std::vector<uint8_t>& config_bytes) {
 
     std::shared_ptr<TF_Status>  status = {TF_NewStatus(), &TF_DeleteStatus};
-    // MANUAL PROTOBUF CONSTRUCTION
-    // Hierarchy: ConfigProto -> GPUOptions (6) -> Experimental (16) -> DisableTF32 (3)
-    // Hex: 32 05 82 01 02 18 00
-
-    //const std::vector<uint8_t> config_bytes = {
-    //  0x32, 0x05,             // Field 6 (GPUOptions), Length 5
-    //  0x82, 0x01, 0x02,       // Field 16 (Experimental), Length 2
-    //  0x18, 0x00              // Field 3 (TF32 Enabled), Value 0 (False)
-    //};
+    // config_bytes is a serialized ConfigProto, build it with
+    // cppflow::session_config (pb_helper.h) rather than by hand
 
     // Pass the raw bytes to TF_SetConfig
     TF_SetConfig(
@@ -81,6 +159,125 @@ namespace cppflow {
     status_check(status.get());
   }
 
+/**
+ * @class prepared_call
+ * @brief A model invocation whose graph endpoints are resolved once
+ *
+ * Created by model::prepare(). The input and output names are parsed and
+ * looked up in the graph only when the call is prepared; every subsequent
+ * call reuses the resolved TF_Output arrays and the TF_Tensor* staging
+ * buffers. A prepared_call is not meant to be shared between threads,
+ * create one per thread instead.
+ */
+class prepared_call {
+ public:
+  prepared_call() = default;
+
+  /**
+   * Runs the model with the given inputs
+   * @param inputs The input tensors, in the order given to model::prepare()
+   * @return The output tensors, in the order given to model::prepare()
+   */
+  std::vector<tensor> operator()(const std::vector<tensor>& inputs);
+
+  /**
+   * Runs the model with the given inputs, reusing the storage of outputs
+   * @param inputs The input tensors, in the order given to model::prepare()
+   * @param outputs Filled with the output tensors
+   */
+  void operator()(const std::vector<tensor>& inputs,
+                  std::vector<tensor>& outputs);
+
+  /**
+   * Runs the model on raw tensors
+   * @param input_values num_inputs() tensors, still owned by the caller
+   * @param output_values Receives num_outputs() tensors owned by the caller
+   */
+  void run(TF_Tensor* const* input_values, TF_Tensor** output_values);
+
+  size_t num_inputs() const { return inp_ops.size(); }
+  size_t num_outputs() const { return out_ops.size(); }
+
+  /**
+   * Bounds the following calls, which throw deadline_exceeded past it
+   * @param timeout The limit of each call, 0 for none
+   */
+  void set_timeout(std::chrono::milliseconds timeout) { timeout_ = timeout; }
+
+ private:
+  friend class model;
+
+  void run_staged(model_metrics::call_scope& scope);
+
+  std::chrono::milliseconds timeout_{0};
+
+  // Keep the graph alive for as long as the session that refers to it
+  std::shared_ptr<TF_Graph> graph;
+  std::shared_ptr<TF_Session> session;
+  std::shared_ptr<TF_Status> status;
+  std::shared_ptr<run_tracer> tracer;
+  std::shared_ptr<model_metrics> metrics;
+
+  std::vector<TF_Output> inp_ops;
+  std::vector<TF_Output> out_ops;
+  std::vector<TF_Tensor*> inp_val;
+  std::vector<TF_Tensor*> out_val;
+};  // Class prepared_call
+
+/**
+ * @class partial_run
+ * @brief One step of a model run in stages, with TF_SessionPRun
+ *
+ * Created by model::start_partial_run() with every input and output that
+ * the step may use. Inputs are then fed and outputs fetched in several
+ * calls; the nodes computed by an earlier call are not run again, so
+ * an encoder can be run once and its result reused by the following
+ * decoder calls. Every input is fed and every output fetched at most once.
+ */
+class partial_run {
+ public:
+  partial_run() = default;
+
+  partial_run(const partial_run&) = delete;
+  partial_run(partial_run&&) = default;
+
+  ~partial_run() = default;
+
+  partial_run& operator=(const partial_run&) = delete;
+  partial_run& operator=(partial_run&&) = default;
+
+  /**
+   * Feeds inputs and fetches outputs within the step
+   * @param inputs Input names and values, among those given at setup
+   * @param outputs Output names, among those given at setup
+   * @return The output tensors
+   */
+  std::vector<tensor> operator()(
+      const std::vector<std::tuple<std::string, tensor>>& inputs,
+      const std::vector<std::string>& outputs);
+
+  /**
+   * Fetches outputs without feeding anything new
+   */
+  std::vector<tensor> fetch(const std::vector<std::string>& outputs) {
+    return (*this)({}, outputs);
+  }
+
+ private:
+  friend class model;
+
+  TF_Output lookup(const std::string& name) const;
+
+  std::shared_ptr<TF_Graph> graph;
+  std::shared_ptr<TF_Session> session;
+  std::shared_ptr<TF_Status> status;
+  std::unique_ptr<const char, decltype(&TF_DeletePRunHandle)> handle = {
+      nullptr, TF_DeletePRunHandle};
+
+  // The endpoints given at setup, by name
+  std::map<std::string, TF_Output> endpoints;
+};  // Class partial_run
+
 class model {
  public:
   enum TYPE {
@@ -88,6 +285,96 @@ class model {
     FROZEN_GRAPH,
   };  // enum TYPE
 
+  struct warmup_options {
+    // Values given to the unknown dims of the inputs, one pass each
+    std::vector<int64_t> batch_sizes = {1};
+
+    // Runs per signature and batch size, the first one is the cold run
+    int iterations = 3;
+
+    // Signatures to run, all of them if empty
+    std::vector<std::string> signatures;
+  };
+
+  struct shard_options {
+    // Rows of the leading dimension per chunk, rounded up so that every
+    // chunk starts on a 64-byte boundary of each input
+    int64_t chunk_rows = 1024;
+
+    // Chunks running at once, including the calling thread. 0 for one per
+    // executor worker plus the calling thread.
+    size_t max_concurrency = 0;
+
+    // Runs the chunks, get_global_executor() if null
+    executor* exec = nullptr;
+  };
+
+  struct warmup_result {
+    std::string signature;
+    int64_t batch_size;
+
+    // Latency of the first run, and mean latency of the following ones
+    double cold_ms;
+    double warm_ms;
+
+    // Set when the signature could not be run, e.g. string inputs
+    std::string error;
+  };
+
+  struct op_cost {
+    std::string name;
+    std::string type;
+
+    // Multiply-adds count as two FLOPs
+    double flops;
+
+    // Bytes of the operands read and of the outputs written
+    double bytes;
+  };
+
+  struct roofline_result {
+    double achieved_gflops;
+
+    // FLOPs per byte moved
+    double arithmetic_intensity;
+
+    // min(peak compute, intensity * peak bandwidth)
+    double attainable_gflops;
+
+    // achieved / attainable
+    double efficiency;
+  };
+
+  struct cost_estimate {
+    int64_t batch_size;
+
+    // Costed ops, most FLOPs first
+    std::vector<op_cost> ops;
+
+    double flops = 0;
+    double parameter_bytes = 0;
+    double activation_bytes = 0;
+
+    // Bytes moved by the costed ops
+    double bytes = 0;
+
+    /**
+     * Compares the estimate with a measured run
+     * @param seconds Latency of one run at batch_size
+     * @param peak_gflops Peak compute of the device
+     * @param peak_gbytes_per_s Peak memory bandwidth of the device
+     */
+    roofline_result roofline(double seconds, double peak_gflops,
+                             double peak_gbytes_per_s) const;
+  };
+
+  /**
+   * Loads a model
+   * @param filename The SavedModel directory or the frozen graph file
+   * @param config_bytes A serialized ConfigProto, a cppflow::session_config
+   *                     converts to it
+   * @param type The format of the model
+   */
   explicit model(const std::string& filename,
                  const std::vector<uint8_t>& config_bytes = {},
                  const TYPE type = TYPE::SAVED_MODEL );
@@ -98,15 +385,143 @@ class model {
 
   model &operator=(const model &other) = default;
   model &operator=(model &&other) = default;
+  /**
+   * Runs the model
+   * @param timeout Cancels the run after this long, throwing
+   *                deadline_exceeded, 0 for no limit
+   */
   std::vector<tensor> operator()(
-      std::vector<std::tuple<std::string, tensor>> inputs,
-      std::vector<std::string> outputs);
+      const std::vector<std::tuple<std::string, tensor>>& inputs,
+      const std::vector<std::string>& outputs,
+      std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
   tensor operator()(const tensor& input);
 
+  /**
+   * Resolves the given graph endpoints once, for repeated calls
+   * @param inputs Names of the input operations (e.g. "serving_default_x:0")
+   * @param outputs Names of the output operations
+   * @return A reusable call object bound to this model's session
+   */
+  prepared_call prepare(const std::vector<std::string>& inputs,
+                        const std::vector<std::string>& outputs) const;
+
+  /**
+   * Sets up a partial run, fed and fetched incrementally
+   * @param inputs Names of every input the step may feed
+   * @param outputs Names of every output the step may fetch
+   */
+  partial_run start_partial_run(const std::vector<std::string>& inputs,
+                                const std::vector<std::string>& outputs) const;
+
+  /**
+   * Runs a signature of the model
+   * @param signature_key The signature to run (e.g. "serving_default")
+   * @param inputs Input tensors keyed by the signature input keys
+   * @param timeout As in operator()
+   * @return Output tensors keyed by the signature output keys
+   */
+  std::map<std::string, tensor> run(
+      const std::string& signature_key,
+      const std::map<std::string, tensor>& inputs,
+      std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) const;
+
+  /**
+   * Runs a large batch as concurrent chunks of its leading dimension
+   * The inputs are sliced without copies, and the output of each chunk is
+   * copied straight into its rows of the preallocated result. Every input
+   * and output must be batch-major with a fixed-size dtype.
+   * @return The output tensors, as operator() would return them
+   */
+  std::vector<tensor> run_sharded(
+      const std::vector<std::tuple<std::string, tensor>>& inputs,
+      const std::vector<std::string>& outputs,
+      const shard_options& options) const;
+
+  /**
+   * Runs the model on an executor, without blocking the calling thread
+   * The names are resolved before returning, so unknown operations throw
+   * here. The task holds the session and copies of the input tensors, so
+   * neither the model nor the inputs have to outlive the call.
+   * @param exec The executor, post() waits while its queue is full
+   * @param timeout Deadline counted from this call: a task still queued
+   *                when it expires fails without running, and a running
+   *                one is cancelled. 0 for no limit.
+   * @return The output tensors, or the error of the run
+   */
+  std::future<std::vector<tensor>> run_async(
+      const std::vector<std::tuple<std::string, tensor>>& inputs,
+      const std::vector<std::string>& outputs,
+      executor& exec = get_global_executor(),
+      std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) const;
+
+  /**
+   * Same as above, reporting the result to a callback
+   * @param callback Called on a worker thread with the outputs and a null
+   *                 exception_ptr, or with no outputs and the error
+   */
+  void run_async(
+      const std::vector<std::tuple<std::string, tensor>>& inputs,
+      const std::vector<std::string>& outputs,
+      std::function<void(std::vector<tensor>, std::exception_ptr)> callback,
+      executor& exec = get_global_executor(),
+      std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) const;
+
+  /**
+   * Runs the signatures on zero-filled inputs, so that the graph
+   * optimizations and the executors are built before the first real call
+   * Input dtypes and shapes come from the signatures, unknown dims are
+   * set to each of the batch sizes in turn. Signatures with string,
+   * resource or variant inputs are skipped.
+   * @return One result per signature and batch size
+   */
+  std::vector<warmup_result> warmup(const warmup_options& options) const;
+  std::vector<warmup_result> warmup() const { return warmup(warmup_options()); }
+
+  /**
+   * Static FLOPs and bytes of the graph, from the op types and the shapes
+   * inferred at load time. Only MatMul, BatchMatMul, Conv2D, depthwise
+   * convolutions, elementwise ops and reductions are costed. Ops inside
+   * functions (e.g. StatefulPartitionedCall bodies) are not visible, so
+   * frozen graphs give the most complete estimates.
+   * @param batch_size Value given to unknown leading dims, other unknown
+   *                   dims count as 1
+   */
+  cost_estimate estimate_cost(int64_t batch_size = 1) const;
+
   std::vector<std::string> get_operations() const;
   std::vector<int64_t> get_operation_shape(const std::string& operation) const;
   void print_signatures();
 
+  /**
+   * Traces one in every_n calls, including prepared calls. Copies of the
+   * model share the tracer.
+   * @param every_n Sampling interval, 0 disables tracing
+   */
+  void enable_tracing(uint64_t every_n) { tracer_->enable(every_n); }
+
+  /**
+   * @return The tracer with the per-op statistics and the timeline
+   */
+  run_tracer& tracer() const { return *tracer_; }
+
+  /**
+   * @return Call counts and per-stage latency histograms of every session
+   *         run of the model, its copies and its prepared calls. Warmup
+   *         runs are not included.
+   */
+  model_metrics::snapshot metrics() const { return metrics_->read(); }
+  void reset_metrics() { metrics_->reset(); }
+
+  /**
+   * @param model_label Value of the "model" label of every sample
+   * @return metrics() in the Prometheus text exposition format
+   */
+  std::string metrics_prometheus(const std::string& model_label) const {
+    return to_prometheus(metrics_->read(), model_label);
+  }
+
+  // Only used while loading the model. Calls on a loaded model use
+  // get_status(), so that a model can be shared between threads
   std::shared_ptr<TF_Status> status;
   std::shared_ptr<TF_Graph> graph;
   std::shared_ptr<TF_Session> session;
@@ -143,8 +558,34 @@ class model {
   }
 
  private:
+  // A signature resolved against the graph, with the checks on its inputs
+  // precomputed. Keys are sorted, as in Signature.
+  struct bound_signature {
+    std::vector<std::string> input_keys;
+    std::vector<TF_Output> inp_ops;
+    std::vector<datatype> inp_dtypes;
+    std::vector<std::vector<int64_t>> inp_shapes;  // -1 for unknown dims
+    std::vector<bool> inp_known_rank;
+
+    std::vector<std::string> output_keys;
+    std::vector<TF_Output> out_ops;
+  };
+
+  // Status for calls on a loaded model, one per thread
+  static TF_Status* get_status();
+
+  TF_Output get_output(const std::string& name) const;
+  void bind_signatures();
+  void run_bound(const bound_signature& sig, TF_Tensor* const* inp_val,
+                 TF_Tensor** out_val, model_metrics::call_scope& scope,
+                 std::chrono::milliseconds timeout =
+                     std::chrono::milliseconds(0)) const;
   TF_Buffer * readGraph(const std::string& filename);
   std::string meta_graph_def_;
+  std::map<std::string, std::shared_ptr<const bound_signature>>
+      bound_signatures_;
+  std::shared_ptr<run_tracer> tracer_ = std::make_shared<run_tracer>();
+  std::shared_ptr<model_metrics> metrics_ = std::make_shared<model_metrics>();
 
 
 };  // Class model
@@ -161,9 +602,12 @@ namespace cppflow {
     std::unique_ptr<TF_SessionOptions, decltype(&TF_DeleteSessionOptions)>
         session_options = {TF_NewSessionOptions(), TF_DeleteSessionOptions};
 
-    auto session_deleter = [this](TF_Session* sess) {
-      TF_DeleteSession(sess, this->status.get());
-      status_check(this->status.get());
+    // The session may outlive this model (e.g. in a prepared_call), so the
+    // deleter must not refer to any member
+    auto session_deleter = [](TF_Session* sess) {
+      std::unique_ptr<TF_Status, decltype(&TF_DeleteStatus)> status = {
+          TF_NewStatus(), &TF_DeleteStatus};
+      TF_DeleteSession(sess, status.get());
     };
 
     setup_SessionOptions(session_options.get(), config_bytes);
@@ -198,6 +642,7 @@ namespace cppflow {
 
         // 2. Parse it
         this->signatures = cppflow::ParseSignatures(blob);
+        this->bind_signatures();
       } else {
         throw std::runtime_error("Failed to import  meta graph data");
       }
@@ -228,6 +673,12 @@ namespace cppflow {
     status_check(this->status.get());
   }
 
+  inline TF_Status* model::get_status() {
+    thread_local std::unique_ptr<TF_Status, decltype(&TF_DeleteStatus)>
+        local_tf_status(TF_NewStatus(), &TF_DeleteStatus);
+    return local_tf_status.get();
+  }
+
   inline std::vector<std::string> model::get_operations() const {
     std::vector<std::string> result;
     size_t pos = 0;
@@ -260,17 +711,18 @@ namespace cppflow {
 
     // Get number of dimensions
     int n_dims = TF_GraphGetTensorNumDims(this->graph.get(), out_op,
-                                          this->status.get());
+                                          get_status());
+    status_check(get_status());
 
     // If is not a scalar
     if (n_dims > 0) {
       // Get dimensions
       auto* dims = new int64_t[n_dims];
       TF_GraphGetTensorShape(this->graph.get(), out_op, dims, n_dims,
-                             this->status.get());
+                             get_status());
 
       // Check error on Model Status
-      status_check(this->status.get());
+      status_check(get_status());
 
       shape = std::vector<int64_t>(dims, dims + n_dims);
 
@@ -280,6 +732,159 @@ namespace cppflow {
     return shape;
   }
 
+  inline model::cost_estimate model::estimate_cost(int64_t batch_size) const {
+    auto* graph = this->graph.get();
+    auto* status = get_status();
+
+    // Shape of a tensor with the unknown dims resolved, false if the rank
+    // is unknown
+    auto shape_of = [&](TF_Output out, std::vector<int64_t>& shape) {
+      int n_dims = TF_GraphGetTensorNumDims(graph, out, status);
+      if (TF_GetCode(status) != TF_OK || n_dims < 0)
+        return false;
+      shape.assign(n_dims, 0);
+      if (n_dims > 0) {
+        TF_GraphGetTensorShape(graph, out, shape.data(), n_dims, status);
+        if (TF_GetCode(status) != TF_OK)
+          return false;
+      }
+      for (int i = 0; i < n_dims; i++)
+        if (shape[i] < 0) shape[i] = i == 0 ? batch_size : 1;
+      return true;
+    };
+    auto num_elements = [](const std::vector<int64_t>& shape) {
+      return std::accumulate(shape.begin(), shape.end(), 1.0,
+                             std::multiplies<double>());
+    };
+    auto bytes_of = [&](TF_Output out) {
+      std::vector<int64_t> shape;
+      if (!shape_of(out, shape))
+        return 0.0;
+      return num_elements(shape) *
+             static_cast<double>(TF_DataTypeSize(TF_OperationOutputType(out)));
+    };
+    auto bool_attr = [&](TF_Operation* oper, const char* name) {
+      unsigned char value = 0;
+      TF_OperationGetAttrBool(oper, name, &value, status);
+      return TF_GetCode(status) == TF_OK && value;
+    };
+
+    // FLOPs per output element
+    static const std::map<std::string, double> elementwise = {
+        {"Add", 1}, {"AddV2", 1}, {"Sub", 1}, {"Mul", 1}, {"Div", 1},
+        {"RealDiv", 1}, {"Maximum", 1}, {"Minimum", 1}, {"Neg", 1},
+        {"Square", 1}, {"SquaredDifference", 2}, {"BiasAdd", 1},
+        {"Relu", 1}, {"Relu6", 1}, {"LeakyRelu", 2}, {"Elu", 4},
+        {"Sqrt", 4}, {"Rsqrt", 4}, {"Exp", 4}, {"Log", 4}, {"Tanh", 4},
+        {"Sigmoid", 4}, {"Erf", 4}, {"Softmax", 5}, {"LogSoftmax", 5},
+        {"FusedBatchNorm", 2}, {"FusedBatchNormV3", 2}};
+    static const std::map<std::string, double> reductions = {
+        {"Sum", 1}, {"Mean", 1}, {"Max", 1}, {"Min", 1}, {"Prod", 1}};
+
+    cost_estimate result;
+    result.batch_size = batch_size;
+
+    size_t pos = 0;
+    TF_Operation* oper;
+    while ((oper = TF_GraphNextOperation(graph, &pos)) != nullptr) {
+      const std::string type = TF_OperationOpType(oper);
+
+      // Parameters, either frozen into constants or held by variables
+      if (type == "Const") {
+        result.parameter_bytes += bytes_of({oper, 0});
+        continue;
+      }
+      if (type == "VarHandleOp" || type == "VariableV2") {
+        TF_DataType dtype;
+        TF_OperationGetAttrType(oper, "dtype", &dtype, status);
+        if (TF_GetCode(status) != TF_OK) continue;
+        auto meta = TF_OperationGetAttrMetadata(oper, "shape", status);
+        if (TF_GetCode(status) != TF_OK || meta.total_size < 0) continue;
+        std::vector<int64_t> shape(meta.total_size);
+        TF_OperationGetAttrShape(oper, "shape", shape.data(),
+                                 static_cast<int>(shape.size()), status);
+        if (TF_GetCode(status) != TF_OK) continue;
+        result.parameter_bytes += num_elements(shape) *
+            static_cast<double>(TF_DataTypeSize(dtype));
+        continue;
+      }
+
+      const int num_inputs = TF_OperationNumInputs(oper);
+      std::vector<std::vector<int64_t>> in_shapes(num_inputs);
+      bool known = true;
+      for (int i = 0; i < num_inputs && known; i++)
+        known = shape_of(TF_OperationInput({oper, i}), in_shapes[i]);
+      std::vector<int64_t> out_shape;
+      if (!known || TF_OperationNumOutputs(oper) == 0 ||
+          !shape_of({oper, 0}, out_shape))
+        continue;
+      const double out_elements = num_elements(out_shape);
+
+      double flops = 0;
+      if (type == "MatMul" && num_inputs == 2 && in_shapes[0].size() == 2) {
+        // [m, k] x [k, n]
+        int64_t k = in_shapes[0][bool_attr(oper, "transpose_a") ? 0 : 1];
+        flops = 2.0 * out_elements * static_cast<double>(k);
+      } else if ((type == "BatchMatMul" || type == "BatchMatMulV2" ||
+                  type == "BatchMatMulV3") && num_inputs == 2 &&
+                 in_shapes[0].size() >= 2) {
+        // [..., m, k] x [..., k, n]
+        const auto& a = in_shapes[0];
+        int64_t k = a[a.size() - (bool_attr(oper, "adj_x") ? 2 : 1)];
+        flops = 2.0 * out_elements * static_cast<double>(k);
+      } else if (type == "Conv2D" && num_inputs == 2 &&
+                 in_shapes[1].size() == 4) {
+        // Filter [kh, kw, in_channels, out_channels]
+        const auto& f = in_shapes[1];
+        flops = 2.0 * out_elements * static_cast<double>(f[0] * f[1] * f[2]);
+      } else if (type == "DepthwiseConv2dNative" && num_inputs == 2 &&
+                 in_shapes[1].size() == 4) {
+        // Filter [kh, kw, in_channels, multiplier], one channel per output
+        const auto& f = in_shapes[1];
+        flops = 2.0 * out_elements * static_cast<double>(f[0] * f[1]);
+      } else if (elementwise.count(type)) {
+        flops = out_elements * elementwise.at(type);
+      } else if (reductions.count(type) && num_inputs > 0) {
+        flops = num_elements(in_shapes[0]) * reductions.at(type);
+      } else {
+        continue;
+      }
+
+      op_cost cost;
+      cost.name = TF_OperationName(oper);
+      cost.type = type;
+      cost.flops = flops;
+      cost.bytes = 0;
+      for (int i = 0; i < num_inputs; i++)
+        cost.bytes += bytes_of(TF_OperationInput({oper, i}));
+      const double out_bytes = bytes_of({oper, 0});
+      cost.bytes += out_bytes;
+
+      result.flops += cost.flops;
+      result.bytes += cost.bytes;
+      result.activation_bytes += out_bytes;
+      result.ops.push_back(std::move(cost));
+    }
+
+    std::stable_sort(result.ops.begin(), result.ops.end(),
+                     [](const op_cost& a, const op_cost& b) {
+                       return a.flops > b.flops;
+                     });
+    return result;
+  }
+
+  inline model::roofline_result model::cost_estimate::roofline(
+      double seconds, double peak_gflops, double peak_gbytes_per_s) const {
+    roofline_result r;
+    r.achieved_gflops = seconds > 0 ? this->flops / seconds / 1e9 : 0.0;
+    r.arithmetic_intensity = this->bytes > 0 ? this->flops / this->bytes : 0.0;
+    r.attainable_gflops = std::min(peak_gflops,
+                                   r.arithmetic_intensity * peak_gbytes_per_s);
+    r.efficiency = r.attainable_gflops > 0 ?
+                   r.achieved_gflops / r.attainable_gflops : 0.0;
+    return r;
+  }
+
   inline std::tuple<std::string, int> parse_name(const std::string& name) {
     auto idx = name.find(':');
     return (idx == std::string::npos ? std::make_tuple(name, 0) :
@@ -287,22 +892,30 @@ namespace cppflow {
             std::stoi(name.substr(idx + 1))));
   }
 
+  inline TF_Output model::get_output(const std::string& name) const {
+    const auto[op_name, op_idx] = parse_name(name);
+    TF_Output out;
+    out.oper = TF_GraphOperationByName(this->graph.get(), op_name.c_str());
+    out.index = op_idx;
+
+    if (!out.oper)
+      throw std::runtime_error("No operation named \"" + op_name + "\" exists");
+
+    return out;
+  }
+
   inline std::vector<tensor> model::operator()(
-      std::vector<std::tuple<std::string, tensor>> inputs,
-      std::vector<std::string> outputs) {
+      const std::vector<std::tuple<std::string, tensor>>& inputs,
+      const std::vector<std::string>& outputs,
+      std::chrono::milliseconds timeout) {
+    model_metrics::call_scope scope(this->metrics_.get());
 
     std::vector<TF_Output> inp_ops(inputs.size());
     std::vector<TF_Tensor*> inp_val(inputs.size(), nullptr);
 
     for (decltype(inputs.size()) i=0; i < inputs.size(); i++) {
       // Operations
-      const auto[op_name, op_idx] = parse_name(std::get<0>(inputs[i]));
-      inp_ops[i].oper = TF_GraphOperationByName(this->graph.get(),
-                                                op_name.c_str());
-      inp_ops[i].index = op_idx;
-
-      if (!inp_ops[i].oper)
-        throw std::runtime_error("No operation named \"" + op_name + "\" exists");
+      inp_ops[i] = this->get_output(std::get<0>(inputs[i]));
 
       // Values
       inp_val[i] = std::get<1>(inputs[i]).get_tensor().get();
@@ -311,66 +924,698 @@ namespace cppflow {
     std::vector<TF_Output> out_ops(outputs.size());
     auto out_val = std::make_unique<TF_Tensor*[]>(outputs.size());
     for (decltype(outputs.size()) i=0; i < outputs.size(); i++) {
-      const auto[op_name, op_idx] = parse_name(outputs[i]);
-      out_ops[i].oper = TF_GraphOperationByName(this->graph.get(),
-                                                op_name.c_str());
-      out_ops[i].index = op_idx;
-
-      if (!out_ops[i].oper)
-        throw std::runtime_error("No operation named \"" + op_name + "\" exists");
+      out_ops[i] = this->get_output(outputs[i]);
     }
+    scope.mark(model_metrics::stage::input);
 
-    TF_SessionRun(this->session.get(), /*run_options*/ NULL,
-                  inp_ops.data(), inp_val.data(), static_cast<int>(inputs.size()),
-                  out_ops.data(), out_val.get(), static_cast<int>(outputs.size()),
-                  /*targets*/ NULL, /*ntargets*/ 0, /*run_metadata*/ NULL,
-                  this->status.get());
-    status_check(this->status.get());
+    session_run(this->session.get(), this->tracer_.get(),
+                inp_ops.data(), inp_val.data(), static_cast<int>(inputs.size()),
+                out_ops.data(), out_val.get(), static_cast<int>(outputs.size()),
+                get_status(), timeout.count());
+    scope.ran(get_status());
+    status_check(get_status());
 
     std::vector<tensor> result;
     result.reserve(outputs.size());
     for (decltype(outputs.size()) i=0; i < outputs.size(); i++) {
       result.emplace_back(tensor(out_val[i]));
     }
+    scope.mark(model_metrics::stage::output);
+    scope.done();
 
     return result;
   }
 
   inline tensor model::operator()(const tensor& input) {
+    // Use the default signature when it has a single input and output
+    auto it = this->bound_signatures_.find("serving_default");
+    if (it != this->bound_signatures_.end() &&
+        it->second->inp_ops.size() == 1 && it->second->out_ops.size() == 1) {
+      model_metrics::call_scope scope(this->metrics_.get());
+      TF_Tensor* inp_val[1] = {input.get_tensor().get()};
+      TF_Tensor* out_val[1] = {nullptr};
+      this->run_bound(*it->second, inp_val, out_val, scope);
+      tensor result(out_val[0]);
+      scope.mark(model_metrics::stage::output);
+      scope.done();
+      return result;
+    }
+
     return (*this)({{"serving_default_input_1", input}},
                    {"StatefulPartitionedCall"})[0];
   }
 
-  inline TF_Buffer * model::readGraph(const std::string& filename) {
-    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+  inline void model::bind_signatures() {
+    for (const auto& [key, sig] : this->signatures) {
+      auto bound = std::make_shared<bound_signature>();
+      try {
+        for (const auto& [input_key, info] : sig.inputs) {
+          bound->input_keys.push_back(input_key);
+          bound->inp_ops.push_back(this->get_output(info.name));
+          bound->inp_dtypes.push_back(info.dtype);
+          bound->inp_shapes.push_back(info.shape);
+          bound->inp_known_rank.push_back(!info.unknown_rank);
+        }
+        for (const auto& [output_key, info] : sig.outputs) {
+          bound->output_keys.push_back(output_key);
+          bound->out_ops.push_back(this->get_output(info.name));
+        }
+      } catch (const std::runtime_error&) {
+        // Signatures referring to missing operations can not be run
+        continue;
+      }
+      this->bound_signatures_[key] = std::move(bound);
+    }
+  }
 
-    // Error opening the file
-    if (!file.is_open()) {
-      std::cerr << "Unable to open file: " << filename << std::endl;
-      return nullptr;
+  inline void model::run_bound(const bound_signature& sig,
+                               TF_Tensor* const* inp_val,
+                               TF_Tensor** out_val,
+                               model_metrics::call_scope& scope,
+                               std::chrono::milliseconds timeout) const {
+    for (decltype(sig.inp_ops.size()) i=0; i < sig.inp_ops.size(); i++) {
+      const auto* t = inp_val[i];
+      if (sig.inp_dtypes[i] != 0 && TF_TensorType(t) != sig.inp_dtypes[i])
+        throw std::runtime_error(
+            "Input \"" + sig.input_keys[i] + "\" expects " +
+            to_string(sig.inp_dtypes[i]) + ", got " +
+            to_string(TF_TensorType(t)));
+
+      if (!sig.inp_known_rank[i])
+        continue;
+
+      const auto& shape = sig.inp_shapes[i];
+      bool match = TF_NumDims(t) == static_cast<int>(shape.size());
+      for (int d = 0; match && d < TF_NumDims(t); d++)
+        match = shape[d] < 0 || shape[d] == TF_Dim(t, d);
+      if (!match)
+        throw std::runtime_error("Input \"" + sig.input_keys[i] +
+                                 "\" does not match the signature shape");
+    }
+    scope.mark(model_metrics::stage::input);
+
+    session_run(this->session.get(), this->tracer_.get(),
+                sig.inp_ops.data(), inp_val,
+                static_cast<int>(sig.inp_ops.size()),
+                sig.out_ops.data(), out_val,
+                static_cast<int>(sig.out_ops.size()),
+                get_status(), timeout.count());
+    scope.ran(get_status());
+    status_check(get_status());
+  }
+
+  inline std::map<std::string, tensor> model::run(
+      const std::string& signature_key,
+      const std::map<std::string, tensor>& inputs,
+      std::chrono::milliseconds timeout) const {
+    auto it = this->bound_signatures_.find(signature_key);
+    if (it == this->bound_signatures_.end())
+      throw std::runtime_error("No signature named \"" + signature_key +
+                               "\" exists");
+    const auto& sig = *it->second;
+    model_metrics::call_scope scope(this->metrics_.get());
+
+    if (inputs.size() != sig.input_keys.size())
+      throw std::runtime_error("Signature \"" + signature_key + "\" expects " +
+                               std::to_string(sig.input_keys.size()) +
+                               " inputs, got " + std::to_string(inputs.size()));
+
+    // Both the inputs and the signature keys are sorted
+    std::vector<TF_Tensor*> inp_val(inputs.size(), nullptr);
+    auto input = inputs.begin();
+    for (decltype(inp_val.size()) i=0; i < inp_val.size(); i++, ++input) {
+      if (input->first != sig.input_keys[i])
+        throw std::runtime_error("Signature \"" + signature_key +
+                                 "\" has no input \"" + input->first + "\"");
+      inp_val[i] = input->second.get_tensor().get();
     }
 
-    // Cursor is at the end to get size
-    auto size = file.tellg();
-    // Move cursor to the beginning
-    file.seekg(0, std::ios::beg);
+    std::vector<TF_Tensor*> out_val(sig.out_ops.size(), nullptr);
+    this->run_bound(sig, inp_val.data(), out_val.data(), scope, timeout);
 
-    // Read
-    auto data = std::make_unique<char[]>(size);
-    file.seekg(0, std::ios::beg);
-    file.read(data.get(), size);
+    std::map<std::string, tensor> result;
+    for (decltype(out_val.size()) i=0; i < out_val.size(); i++)
+      result.emplace_hint(result.end(), sig.output_keys[i], tensor(out_val[i]));
+    scope.mark(model_metrics::stage::output);
+    scope.done();
 
-    // Error reading the file
-    if (!file) {
-      std::cerr << "Unable to read the full file: " << filename << std::endl;
-      return nullptr;
+    return result;
+  }
+
+  inline prepared_call model::prepare(
+      const std::vector<std::string>& inputs,
+      const std::vector<std::string>& outputs) const {
+    prepared_call call;
+    call.graph = this->graph;
+    call.session = this->session;
+    call.status = {TF_NewStatus(), &TF_DeleteStatus};
+    call.tracer = this->tracer_;
+    call.metrics = this->metrics_;
+
+    call.inp_ops.reserve(inputs.size());
+    for (const auto& name : inputs)
+      call.inp_ops.push_back(this->get_output(name));
+
+    call.out_ops.reserve(outputs.size());
+    for (const auto& name : outputs)
+      call.out_ops.push_back(this->get_output(name));
+
+    call.inp_val.assign(inputs.size(), nullptr);
+    call.out_val.assign(outputs.size(), nullptr);
+    return call;
+  }
+
+  inline std::vector<model::warmup_result> model::warmup(
+      const warmup_options& options) const {
+    using clock = std::chrono::steady_clock;
+    using deleter = decltype(&TF_DeleteTensor);
+
+    std::vector<warmup_result> results;
+    for (const auto& [key, sig] : this->bound_signatures_) {
+      if (!options.signatures.empty() &&
+          std::find(options.signatures.begin(), options.signatures.end(),
+                    key) == options.signatures.end())
+        continue;
+
+      for (auto batch_size : options.batch_sizes) {
+        warmup_result result{key, batch_size, 0.0, 0.0, {}};
+
+        std::vector<std::unique_ptr<TF_Tensor, deleter>> inputs;
+        std::vector<TF_Tensor*> inp_val;
+        for (decltype(sig->inp_ops.size()) i=0; i < sig->inp_ops.size(); i++) {
+          auto dtype = sig->inp_dtypes[i];
+          if (dtype == 0 || TF_DataTypeSize(dtype) == 0) {
+            result.error = "Input \"" + sig->input_keys[i] + "\" of type " +
+                           to_string(dtype) + " can not be synthesized";
+            break;
+          }
+
+          // Unknown ranks are fed as vectors of batch_size elements
+          std::vector<int64_t> shape = sig->inp_known_rank[i] ?
+              sig->inp_shapes[i] : std::vector<int64_t>{-1};
+          size_t num_elements = 1;
+          for (auto& d : shape) {
+            if (d < 0) d = batch_size;
+            num_elements *= static_cast<size_t>(d);
+          }
+
+          size_t len = num_elements * TF_DataTypeSize(dtype);
+          inputs.emplace_back(TF_AllocateTensor(dtype, shape.data(),
+                                                static_cast<int>(shape.size()),
+                                                len),
+                              TF_DeleteTensor);
+          if (len > 0)
+            std::memset(TF_TensorData(inputs.back().get()), 0, len);
+          inp_val.push_back(inputs.back().get());
+        }
+
+        if (result.error.empty()) {
+          std::vector<TF_Tensor*> out_val(sig->out_ops.size(), nullptr);
+          double warm_total = 0.0;
+          for (int it = 0; it < options.iterations; it++) {
+            auto start = clock::now();
+            try {
+              // Warmup runs are kept out of the metrics
+              model_metrics::call_scope scope(nullptr);
+              this->run_bound(*sig, inp_val.data(), out_val.data(), scope);
+            } catch (const std::runtime_error& e) {
+              result.error = e.what();
+              break;
+            }
+            std::chrono::duration<double, std::milli> elapsed =
+                clock::now() - start;
+
+            for (auto& t : out_val) {
+              TF_DeleteTensor(t);
+              t = nullptr;
+            }
+
+            if (it == 0)
+              result.cold_ms = elapsed.count();
+            else
+              warm_total += elapsed.count();
+          }
+          if (options.iterations > 1)
+            result.warm_ms = warm_total / (options.iterations - 1);
+        }
+
+        results.push_back(std::move(result));
+      }
     }
+    return results;
+  }
 
-    // Create tensorflow buffer from read data
-    TF_Buffer* buffer = TF_NewBufferFromString(data.get(), size);
+  inline std::vector<tensor> model::run_sharded(
+      const std::vector<std::tuple<std::string, tensor>>& inputs,
+      const std::vector<std::string>& outputs,
+      const shard_options& options) const {
+    using tensor_ptr = std::shared_ptr<TF_Tensor>;
+
+    if (inputs.empty())
+      throw std::runtime_error("Sharded runs need at least one input");
+
+    // Every input is split along the same leading dimension
+    std::vector<tensor_ptr> parents;
+    std::vector<size_t> row_bytes;
+    int64_t rows = -1;
+    size_t align_rows = 1;
+    for (const auto& input : inputs) {
+      auto t = std::get<1>(input).get_tensor();
+      if (TF_NumDims(t.get()) < 1 || TF_DataTypeSize(TF_TensorType(t.get())) == 0)
+        throw std::runtime_error("Input \"" + std::get<0>(input) +
+                                 "\" can not be sharded");
+      if (rows >= 0 && TF_Dim(t.get(), 0) != rows)
+        throw std::runtime_error("Sharded inputs must have the same batch size");
+      rows = TF_Dim(t.get(), 0);
+
+      size_t bytes = rows > 0 ? TF_TensorByteSize(t.get()) / rows : 0;
+      row_bytes.push_back(bytes);
+      if (bytes > 0) {
+        // TF copies tensors whose data is not 64-byte aligned
+        size_t k = 64 / std::gcd(bytes, size_t(64));
+        align_rows = std::lcm(align_rows, k);
+      }
+      parents.push_back(std::move(t));
+    }
+
+    int64_t chunk = std::max<int64_t>(1, options.chunk_rows);
+    chunk = (chunk + align_rows - 1) / align_rows * align_rows;
+    const size_t num_chunks = rows > 0 ? (rows + chunk - 1) / chunk : 0;
+
+    std::vector<std::string> names;
+    std::vector<tensor> values;
+    for (const auto& input : inputs) {
+      names.push_back(std::get<0>(input));
+      values.push_back(std::get<1>(input));
+    }
+    prepared_call prototype = this->prepare(names, outputs);
+    if (num_chunks <= 1)
+      return prototype(values);
+
+    // Shared with the tasks, which may outlive this call if they start
+    // after every chunk is done
+    struct shared_state {
+      std::atomic<size_t> next{0};
+      std::mutex mutex;
+      std::condition_variable done_cv;
+      size_t done = 0;
+      std::exception_ptr error;
+      std::once_flag allocated;
+      std::vector<std::unique_ptr<TF_Tensor, decltype(&TF_DeleteTensor)>>
+          results;
+    };
+    auto state = std::make_shared<shared_state>();
+
+    auto run_chunk = [=](prepared_call& call, int64_t begin, int64_t count) {
+      using owned_tensor = std::unique_ptr<TF_Tensor, decltype(&TF_DeleteTensor)>;
+
+      // Zero-copy slices, each holding a reference to its parent
+      std::vector<owned_tensor> slices;
+      std::vector<TF_Tensor*> inp_val;
+      for (size_t i = 0; i < parents.size(); i++) {
+        TF_Tensor* p = parents[i].get();
+        std::vector<int64_t> dims(TF_NumDims(p));
+        for (int d = 0; d < TF_NumDims(p); d++)
+          dims[d] = TF_Dim(p, d);
+        dims[0] = count;
+
+        auto* owner = new tensor_ptr(parents[i]);
+        slices.emplace_back(
+            TF_NewTensor(TF_TensorType(p), dims.data(),
+                         static_cast<int>(dims.size()),
+                         static_cast<char*>(TF_TensorData(p)) +
+                             begin * row_bytes[i],
+                         count * row_bytes[i],
+                         [](void*, size_t, void* arg) {
+                           delete static_cast<tensor_ptr*>(arg);
+                         }, owner),
+            TF_DeleteTensor);
+        inp_val.push_back(slices.back().get());
+      }
+
+      std::vector<TF_Tensor*> out_val(call.num_outputs(), nullptr);
+      call.run(inp_val.data(), out_val.data());
+      std::vector<owned_tensor> chunk_outputs;
+      for (auto* t : out_val)
+        chunk_outputs.emplace_back(t, TF_DeleteTensor);
+
+      for (auto& out : chunk_outputs) {
+        if (TF_NumDims(out.get()) < 1 || TF_Dim(out.get(), 0) != count ||
+            TF_DataTypeSize(TF_TensorType(out.get())) == 0)
+          throw std::runtime_error("Sharded outputs must be batch-major "
+                                   "with a fixed-size dtype");
+      }
+
+      // The first chunk to finish allocates the results
+      std::call_once(state->allocated, [&] {
+        for (auto& out : chunk_outputs) {
+          std::vector<int64_t> dims(TF_NumDims(out.get()));
+          for (int d = 0; d < TF_NumDims(out.get()); d++)
+            dims[d] = TF_Dim(out.get(), d);
+          dims[0] = rows;
+          size_t len = TF_TensorByteSize(out.get()) / count * rows;
+          state->results.emplace_back(
+              TF_AllocateTensor(TF_TensorType(out.get()), dims.data(),
+                                static_cast<int>(dims.size()), len),
+              TF_DeleteTensor);
+        }
+      });
+
+      for (size_t o = 0; o < chunk_outputs.size(); o++) {
+        TF_Tensor* out = chunk_outputs[o].get();
+        TF_Tensor* result = state->results[o].get();
+        size_t out_row_bytes = TF_TensorByteSize(out) / count;
+        if (TF_TensorType(out) != TF_TensorType(result) ||
+            out_row_bytes * rows != TF_TensorByteSize(result))
+          throw std::runtime_error("Sharded outputs differ between chunks");
+        std::memcpy(static_cast<char*>(TF_TensorData(result)) +
+                        begin * out_row_bytes,
+                    TF_TensorData(out), TF_TensorByteSize(out));
+      }
+    };
+
+    auto work = [=]() {
+      prepared_call call = prototype;
+      call.status = {TF_NewStatus(), &TF_DeleteStatus};
+
+      for (size_t c = state->next++; c < num_chunks; c = state->next++) {
+        const int64_t begin = static_cast<int64_t>(c) * chunk;
+        bool failed;
+        {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          failed = state->error != nullptr;
+        }
 
-    // Close file and remove data
-    file.close();
+        // After a failure the remaining chunks are only counted
+        if (!failed) {
+          try {
+            run_chunk(call, begin, std::min(chunk, rows - begin));
+          } catch (...) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (!state->error)
+              state->error = std::current_exception();
+          }
+        }
+
+        {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          state->done++;
+        }
+        state->done_cv.notify_all();
+      }
+    };
+
+    executor& exec = options.exec ? *options.exec : get_global_executor();
+    size_t concurrency = options.max_concurrency > 0 ?
+        options.max_concurrency : exec.num_threads() + 1;
+    concurrency = std::min(concurrency, num_chunks);
+    for (size_t i = 1; i < concurrency; i++) {
+      if (!exec.try_post(work))
+        break;  // The calling thread takes the remaining chunks
+    }
+
+    // The calling thread works too, so the call completes even if the
+    // executor is busy (or is the one running this call)
+    work();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done_cv.wait(lock, [&] { return state->done == num_chunks; });
+    if (state->error)
+      std::rethrow_exception(state->error);
+
+    std::vector<tensor> result;
+    for (auto& t : state->results)
+      result.emplace_back(t.release());
+    return result;
+  }
+
+  inline void model::run_async(
+      const std::vector<std::tuple<std::string, tensor>>& inputs,
+      const std::vector<std::string>& outputs,
+      std::function<void(std::vector<tensor>, std::exception_ptr)> callback,
+      executor& exec, std::chrono::milliseconds timeout) const {
+    std::vector<std::string> names;
+    std::vector<tensor> values;
+    names.reserve(inputs.size());
+    values.reserve(inputs.size());
+    for (const auto& [name, value] : inputs) {
+      names.push_back(name);
+      values.push_back(value);
+    }
+
+    // std::function needs a copyable task
+    auto call = std::make_shared<prepared_call>(this->prepare(names, outputs));
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    exec.post([call, values = std::move(values),
+               callback = std::move(callback), timeout, deadline] {
+      std::vector<tensor> result;
+      try {
+        if (timeout.count() > 0) {
+          // Do not hold a worker for a call whose caller gave up
+          auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+              deadline - std::chrono::steady_clock::now());
+          if (left.count() <= 0) {
+            if (call->metrics) call->metrics->record_expired();
+            throw deadline_exceeded("Deadline exceeded before the run started");
+          }
+          call->set_timeout(left);
+        }
+        result = (*call)(values);
+      } catch (...) {
+        callback({}, std::current_exception());
+        return;
+      }
+      callback(std::move(result), nullptr);
+    });
+  }
+
+  inline std::future<std::vector<tensor>> model::run_async(
+      const std::vector<std::tuple<std::string, tensor>>& inputs,
+      const std::vector<std::string>& outputs,
+      executor& exec, std::chrono::milliseconds timeout) const {
+    auto promise = std::make_shared<std::promise<std::vector<tensor>>>();
+    auto future = promise->get_future();
+    this->run_async(inputs, outputs,
+        [promise](std::vector<tensor> result, std::exception_ptr error) {
+          if (error)
+            promise->set_exception(error);
+          else
+            promise->set_value(std::move(result));
+        }, exec, timeout);
+    return future;
+  }
+
+  inline partial_run model::start_partial_run(
+      const std::vector<std::string>& inputs,
+      const std::vector<std::string>& outputs) const {
+    partial_run run;
+    run.graph = this->graph;
+    run.session = this->session;
+    run.status = {TF_NewStatus(), &TF_DeleteStatus};
+
+    std::vector<TF_Output> inp_ops, out_ops;
+    for (const auto& name : inputs) {
+      inp_ops.push_back(this->get_output(name));
+      run.endpoints[name] = inp_ops.back();
+    }
+    for (const auto& name : outputs) {
+      out_ops.push_back(this->get_output(name));
+      run.endpoints[name] = out_ops.back();
+    }
+
+    const char* handle = nullptr;
+    TF_SessionPRunSetup(this->session.get(),
+                        inp_ops.data(), static_cast<int>(inp_ops.size()),
+                        out_ops.data(), static_cast<int>(out_ops.size()),
+                        /*targets*/ NULL, /*ntargets*/ 0,
+                        &handle, run.status.get());
+    status_check(run.status.get());
+    run.handle.reset(handle);
+    return run;
+  }
+
+  inline TF_Output partial_run::lookup(const std::string& name) const {
+    auto it = this->endpoints.find(name);
+    if (it == this->endpoints.end())
+      throw std::runtime_error("\"" + name + "\" was not given when the "
+                               "partial run was set up");
+    return it->second;
+  }
+
+  inline std::vector<tensor> partial_run::operator()(
+      const std::vector<std::tuple<std::string, tensor>>& inputs,
+      const std::vector<std::string>& outputs) {
+    if (!this->handle)
+      throw std::runtime_error("Partial run was not set up by a model");
+
+    std::vector<TF_Output> inp_ops(inputs.size());
+    std::vector<TF_Tensor*> inp_val(inputs.size(), nullptr);
+    for (decltype(inputs.size()) i=0; i < inputs.size(); i++) {
+      inp_ops[i] = this->lookup(std::get<0>(inputs[i]));
+      inp_val[i] = std::get<1>(inputs[i]).get_tensor().get();
+    }
+
+    std::vector<TF_Output> out_ops(outputs.size());
+    std::vector<TF_Tensor*> out_val(outputs.size(), nullptr);
+    for (decltype(outputs.size()) i=0; i < outputs.size(); i++)
+      out_ops[i] = this->lookup(outputs[i]);
+
+    TF_SessionPRun(this->session.get(), this->handle.get(),
+                   inp_ops.data(), inp_val.data(),
+                   static_cast<int>(inp_ops.size()),
+                   out_ops.data(), out_val.data(),
+                   static_cast<int>(out_ops.size()),
+                   /*targets*/ NULL, /*ntargets*/ 0, this->status.get());
+    status_check(this->status.get());
+
+    std::vector<tensor> result;
+    result.reserve(outputs.size());
+    for (auto* t : out_val)
+      result.emplace_back(t);
+    return result;
+  }
+
+  inline void prepared_call::run_staged(model_metrics::call_scope& scope) {
+    scope.mark(model_metrics::stage::input);
+    session_run(this->session.get(), this->tracer.get(),
+                this->inp_ops.data(), this->inp_val.data(),
+                static_cast<int>(this->inp_ops.size()),
+                this->out_ops.data(), this->out_val.data(),
+                static_cast<int>(this->out_ops.size()),
+                this->status.get(), this->timeout_.count());
+    scope.ran(this->status.get());
+
+    // Input tensors are owned by the caller, do not keep dangling pointers
+    std::fill(this->inp_val.begin(), this->inp_val.end(), nullptr);
+    status_check(this->status.get());
+  }
+
+  inline void prepared_call::operator()(const std::vector<tensor>& inputs,
+                                        std::vector<tensor>& outputs) {
+    if (!this->session)
+      throw std::runtime_error("Call was not prepared by a model");
+    model_metrics::call_scope scope(this->metrics.get());
+
+    if (inputs.size() != this->inp_ops.size())
+      throw std::runtime_error("Prepared call expects " +
+                               std::to_string(this->inp_ops.size()) +
+                               " inputs, got " + std::to_string(inputs.size()));
+
+    for (decltype(inputs.size()) i=0; i < inputs.size(); i++)
+      this->inp_val[i] = inputs[i].get_tensor().get();
+
+    this->run_staged(scope);
+
+    outputs.resize(this->out_val.size());
+    for (decltype(outputs.size()) i=0; i < outputs.size(); i++) {
+      outputs[i] = tensor(this->out_val[i]);
+      this->out_val[i] = nullptr;
+    }
+    scope.mark(model_metrics::stage::output);
+    scope.done();
+  }
+
+  inline std::vector<tensor> prepared_call::operator()(
+      const std::vector<tensor>& inputs) {
+    std::vector<tensor> outputs;
+    (*this)(inputs, outputs);
+    return outputs;
+  }
+
+  inline void prepared_call::run(TF_Tensor* const* input_values,
+                                 TF_Tensor** output_values) {
+    if (!this->session)
+      throw std::runtime_error("Call was not prepared by a model");
+    model_metrics::call_scope scope(this->metrics.get());
+
+    std::copy(input_values, input_values + this->inp_val.size(),
+              this->inp_val.begin());
+    this->run_staged(scope);
+    std::copy(this->out_val.begin(), this->out_val.end(), output_values);
+    std::fill(this->out_val.begin(), this->out_val.end(), nullptr);
+    scope.mark(model_metrics::stage::output);
+    scope.done();
+  }
+
+  inline TF_Buffer * model::readGraph(const std::string& filename) {
+    // The file is mapped rather than read, so the graph is not copied
+    // before TF parses it. The buffer unmaps it when deleted.
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+      std::cerr << "Unable to open file: " << filename << std::endl;
+      return nullptr;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+      CloseHandle(file);
+      std::cerr << "Unable to read the full file: " << filename << std::endl;
+      return nullptr;
+    }
+    TF_Buffer* buffer = TF_NewBuffer();
+    if (size.QuadPart > 0) {
+      HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0,
+                                          NULL);
+      void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) :
+                             nullptr;
+      // The view keeps the mapping alive
+      if (mapping) CloseHandle(mapping);
+      if (data == nullptr) {
+        CloseHandle(file);
+        TF_DeleteBuffer(buffer);
+        std::cerr << "Unable to read the full file: " << filename << std::endl;
+        return nullptr;
+      }
+      buffer->data = data;
+      buffer->length = static_cast<size_t>(size.QuadPart);
+      buffer->data_deallocator = [](void* data, size_t) {
+        UnmapViewOfFile(data);
+      };
+    }
+    CloseHandle(file);
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      std::cerr << "Unable to open file: " << filename << std::endl;
+      return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      std::cerr << "Unable to read the full file: " << filename << std::endl;
+      return nullptr;
+    }
+    TF_Buffer* buffer = TF_NewBuffer();
+    if (st.st_size > 0) {
+      const size_t size = static_cast<size_t>(st.st_size);
+      void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        close(fd);
+        TF_DeleteBuffer(buffer);
+        std::cerr << "Unable to read the full file: " << filename << std::endl;
+        return nullptr;
+      }
+      // Parsed front to back, once
+      madvise(data, size, MADV_SEQUENTIAL);
+      buffer->data = data;
+      buffer->length = size;
+      buffer->data_deallocator = [](void* data, size_t length) {
+        munmap(data, length);
+      };
+    }
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+#endif  // _WIN32
+
+    if (buffer->data != nullptr &&
+        IsMemmappedPackage(static_cast<const uint8_t*>(buffer->data),
+                           buffer->length)) {
+      TF_DeleteBuffer(buffer);
+      throw std::runtime_error(
+          filename + " is a memmapped package, which needs TensorFlow's "
+          "MemmappedEnv; the C API can only import plain GraphDef files");
+    }
 
     return buffer;
   }
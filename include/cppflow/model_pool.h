@@ -0,0 +1,365 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/*!
+ *  @file       model_pool.h
+ *  @brief      Replicated sessions of one SavedModel, pinned to core sets
+ */
+
+#ifndef INCLUDE_CPPFLOW_MODEL_POOL_H_
+#define INCLUDE_CPPFLOW_MODEL_POOL_H_
+
+// C headers
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif  // __linux__
+
+// C++ headers
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// CppFlow headers
+#include "cppflow/model.h"
+#include "cppflow/pb_helper.h"
+#include "cppflow/tensor.h"
+
+namespace cppflow {
+
+/**
+ * @class model_pool
+ * @brief N sessions over the same SavedModel, dispatched by load
+ *
+ * Every replica loads its own copy of the model with its own intra/inter-op
+ * thread pools. A replica can be pinned to a set of cores or to a NUMA node:
+ * it is loaded from a thread with that CPU affinity, so the session thread
+ * pools inherit it and the weights are first touched on the local node.
+ * Calls go to the replica with the fewest calls in flight.
+ */
+class model_pool {
+ public:
+  struct replica_options {
+    // Thread pool sizes of the session, 0 lets TensorFlow choose
+    int intra_op_threads = 0;
+    int inter_op_threads = 0;
+
+    // Cores the session threads run on, empty for no pinning
+    std::vector<int> cpus;
+
+    // If >= 0 and cpus is empty, pin to the cores of this NUMA node
+    int numa_node = -1;
+  };
+
+  struct replica_stats {
+    size_t calls;
+    size_t in_flight;
+
+    // Time with at least one call in flight, and its share of the time
+    // since the pool was created or the stats were reset
+    double busy_seconds;
+    double utilisation;
+  };
+
+  /**
+   * Loads one replica per entry of replicas, in parallel
+   * @param filename The SavedModel directory
+   * @param replicas The options of every replica
+   * @param config_bytes Serialized ConfigProto shared by all replicas, the
+   *                     thread settings of each replica are applied on top
+   */
+  model_pool(const std::string& filename,
+             const std::vector<replica_options>& replicas,
+             const std::vector<uint8_t>& config_bytes = {});
+
+  model_pool(const model_pool&) = delete;
+  model_pool(model_pool&&) = delete;
+
+  ~model_pool() = default;
+
+  model_pool& operator=(const model_pool&) = delete;
+  model_pool& operator=(model_pool&&) = delete;
+
+  std::vector<tensor> operator()(
+      const std::vector<std::tuple<std::string, tensor>>& inputs,
+      const std::vector<std::string>& outputs);
+
+  std::map<std::string, tensor> run(
+      const std::string& signature_key,
+      const std::map<std::string, tensor>& inputs);
+
+  /**
+   * Calls func on the least loaded replica
+   * @param func Callable taking a cppflow::model&
+   * @return The result of func
+   */
+  template<typename Func>
+  auto call(Func&& func);
+
+  size_t size() const { return replicas.size(); }
+  model& replica(size_t i) { return *replicas.at(i)->m; }
+
+  std::vector<replica_stats> stats() const;
+  void reset_stats();
+
+  /**
+   * @param node A NUMA node
+   * @return The cores of the node, as listed by sysfs
+   */
+  static std::vector<int> numa_node_cpus(int node);
+
+ private:
+  struct replica_state {
+    std::unique_ptr<model> m;
+
+    std::atomic<size_t> in_flight{0};
+    mutable std::mutex mutex;
+    size_t calls = 0;
+    std::chrono::steady_clock::duration busy{0};
+    std::chrono::steady_clock::time_point busy_since;
+  };
+
+  // Marks a call in flight on a replica for the lifetime of the object
+  class lease {
+   public:
+    explicit lease(replica_state& r);
+    ~lease();
+    lease(const lease&) = delete;
+    lease& operator=(const lease&) = delete;
+
+   private:
+    replica_state& r;
+  };
+
+  static std::vector<uint8_t> replica_config(
+      const std::vector<uint8_t>& config_bytes, const replica_options& opts);
+  static void pin_current_thread(const std::vector<int>& cpus);
+
+  replica_state& least_loaded();
+
+  std::vector<std::unique_ptr<replica_state>> replicas;
+  std::atomic<size_t> next{0};
+
+  mutable std::mutex stats_mutex;
+  std::chrono::steady_clock::time_point stats_since;
+};  // Class model_pool
+
+}  // namespace cppflow
+
+
+/******************************
+ *   IMPLEMENTATION DETAILS   *
+ ******************************/
+
+
+namespace cppflow {
+
+inline model_pool::model_pool(const std::string& filename,
+                              const std::vector<replica_options>& replicas,
+                              const std::vector<uint8_t>& config_bytes) {
+  if (replicas.empty())
+    throw std::runtime_error("A model pool needs at least one replica");
+
+  std::vector<std::exception_ptr> errors(replicas.size());
+  std::vector<std::thread> loaders;
+  for (decltype(replicas.size()) i=0; i < replicas.size(); i++) {
+    this->replicas.push_back(std::make_unique<replica_state>());
+    loaders.emplace_back([&, i] {
+      try {
+        auto cpus = replicas[i].cpus;
+        if (cpus.empty() && replicas[i].numa_node >= 0)
+          cpus = numa_node_cpus(replicas[i].numa_node);
+        pin_current_thread(cpus);
+
+        this->replicas[i]->m = std::make_unique<model>(
+            filename, replica_config(config_bytes, replicas[i]));
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    });
+  }
+  for (auto& t : loaders)
+    t.join();
+  for (auto& e : errors)
+    if (e) std::rethrow_exception(e);
+
+  this->stats_since = std::chrono::steady_clock::now();
+}
+
+inline std::vector<uint8_t> model_pool::replica_config(
+    const std::vector<uint8_t>& config_bytes, const replica_options& opts) {
+  // ConfigProto fields, appended so that they override config_bytes
+  ProtoWriter config(config_bytes);
+  if (opts.intra_op_threads > 0)
+    config.write_int(2, opts.intra_op_threads);  // intra_op_parallelism_threads
+  if (opts.inter_op_threads > 0)
+    config.write_int(5, opts.inter_op_threads);  // inter_op_parallelism_threads
+
+  // Without per-session pools all replicas would share the process-wide
+  // pools, created (and pinned) by whichever replica loads first
+  config.write_bool(9, true);                    // use_per_session_threads
+  return config.data();
+}
+
+inline void model_pool::pin_current_thread(const std::vector<int>& cpus) {
+  if (cpus.empty())
+    return;
+
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+      throw std::runtime_error("Invalid CPU " + std::to_string(cpu));
+    CPU_SET(cpu, &set);
+  }
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+    throw std::runtime_error("Unable to set the CPU affinity");
+#else
+  throw std::runtime_error("CPU pinning is only supported on Linux");
+#endif  // __linux__
+}
+
+inline std::vector<int> model_pool::numa_node_cpus(int node) {
+  std::string path = "/sys/devices/system/node/node" + std::to_string(node) +
+                     "/cpulist";
+  std::ifstream file(path);
+  std::string list;
+  if (!file.is_open() || !std::getline(file, list))
+    throw std::runtime_error("Unable to read " + path);
+
+  // Format: "0-15,32-47"
+  std::vector<int> cpus;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty()) continue;
+    auto dash = range.find('-');
+    int first = std::stoi(range.substr(0, dash));
+    int last = dash == std::string::npos ? first :
+               std::stoi(range.substr(dash + 1));
+    for (int cpu = first; cpu <= last; cpu++)
+      cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+inline model_pool::lease::lease(replica_state& r) : r(r) {
+  std::lock_guard<std::mutex> lock(r.mutex);
+  if (r.in_flight++ == 0)
+    r.busy_since = std::chrono::steady_clock::now();
+  r.calls++;
+}
+
+inline model_pool::lease::~lease() {
+  std::lock_guard<std::mutex> lock(r.mutex);
+  if (--r.in_flight == 0)
+    r.busy += std::chrono::steady_clock::now() - r.busy_since;
+}
+
+inline model_pool::replica_state& model_pool::least_loaded() {
+  // Start at a rotating index so ties are spread over the replicas
+  const size_t n = this->replicas.size();
+  const size_t start = this->next.fetch_add(1, std::memory_order_relaxed);
+
+  size_t best = start % n;
+  size_t best_load = std::numeric_limits<size_t>::max();
+  for (size_t k = 0; k < n; k++) {
+    size_t i = (start + k) % n;
+    size_t load = this->replicas[i]->in_flight.load(std::memory_order_relaxed);
+    if (load < best_load) {
+      best = i;
+      best_load = load;
+    }
+  }
+  return *this->replicas[best];
+}
+
+template<typename Func>
+auto model_pool::call(Func&& func) {
+  auto& r = this->least_loaded();
+  lease l(r);
+  return func(*r.m);
+}
+
+inline std::vector<tensor> model_pool::operator()(
+    const std::vector<std::tuple<std::string, tensor>>& inputs,
+    const std::vector<std::string>& outputs) {
+  return this->call([&](model& m) { return m(inputs, outputs); });
+}
+
+inline std::map<std::string, tensor> model_pool::run(
+    const std::string& signature_key,
+    const std::map<std::string, tensor>& inputs) {
+  return this->call([&](model& m) { return m.run(signature_key, inputs); });
+}
+
+inline std::vector<model_pool::replica_stats> model_pool::stats() const {
+  std::lock_guard<std::mutex> stats_lock(this->stats_mutex);
+  const auto now = std::chrono::steady_clock::now();
+  const std::chrono::duration<double> elapsed = now - this->stats_since;
+
+  std::vector<replica_stats> result;
+  for (const auto& r : this->replicas) {
+    std::lock_guard<std::mutex> lock(r->mutex);
+    auto busy = r->busy;
+    if (r->in_flight > 0)
+      busy += now - r->busy_since;
+
+    const std::chrono::duration<double> busy_seconds = busy;
+    replica_stats s;
+    s.calls = r->calls;
+    s.in_flight = r->in_flight;
+    s.busy_seconds = busy_seconds.count();
+    s.utilisation = elapsed.count() > 0 ?
+                    busy_seconds.count() / elapsed.count() : 0.0;
+    result.push_back(s);
+  }
+  return result;
+}
+
+inline void model_pool::reset_stats() {
+  std::lock_guard<std::mutex> stats_lock(this->stats_mutex);
+  const auto now = std::chrono::steady_clock::now();
+  for (auto& r : this->replicas) {
+    std::lock_guard<std::mutex> lock(r->mutex);
+    r->calls = 0;
+    r->busy = std::chrono::steady_clock::duration{0};
+    r->busy_since = now;
+  }
+  this->stats_since = now;
+}
+
+}  // namespace cppflow
+
+#endif  // INCLUDE_CPPFLOW_MODEL_POOL_H_
@@ -0,0 +1,307 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/*!
+ *  @file       model_registry.h
+ *  @brief      Memory-bounded cache of lazily loaded models
+ */
+
+#ifndef INCLUDE_CPPFLOW_MODEL_REGISTRY_H_
+#define INCLUDE_CPPFLOW_MODEL_REGISTRY_H_
+
+// C++ headers
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// CppFlow headers
+#include "cppflow/model.h"
+
+namespace cppflow {
+
+/**
+ * @class model_registry
+ * @brief Loads models on first use and evicts the least recently used ones
+ *
+ * Models are keyed by path and version and loaded when first requested.
+ * Concurrent requests for a model that is loading wait for that single
+ * load. Each model is charged an estimate of its resident size; when the
+ * total exceeds the budget, the least recently used models are dropped
+ * from the registry. Callers still holding an evicted model keep it alive
+ * until they release it.
+ */
+class model_registry {
+ public:
+  struct options {
+    // Total estimated size of the cached models, 0 for no limit
+    size_t memory_budget = 0;
+
+    // Serialized ConfigProto of every model
+    std::vector<uint8_t> config_bytes;
+
+    // Estimates the resident size of the SavedModel in a directory,
+    // estimate_size() if empty
+    std::function<size_t(const std::string& dir)> size_estimator;
+  };
+
+  struct stats {
+    size_t models;
+    size_t resident_bytes;
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+  };
+
+  explicit model_registry(size_t memory_budget = 0);
+  explicit model_registry(options opts);
+
+  model_registry(const model_registry&) = delete;
+  model_registry& operator=(const model_registry&) = delete;
+
+  /**
+   * Returns a model, loading it if it is not cached
+   * @param path A SavedModel directory, or a base directory of versions
+   * @param version Loads path/<version> if >= 0, path itself otherwise
+   * @return The model, valid for as long as it is held even if evicted
+   */
+  std::shared_ptr<model> get(const std::string& path, int64_t version = -1);
+
+  bool contains(const std::string& path, int64_t version = -1) const;
+
+  /**
+   * Drops a model from the registry, a load in progress is not affected
+   */
+  void evict(const std::string& path, int64_t version = -1);
+  void clear();
+
+  stats get_stats() const;
+
+  /**
+   * Default size estimate: the size of the variables, which are loaded in
+   * memory, plus twice the size of the graph, which is parsed and then
+   * imported
+   * @param dir A SavedModel directory
+   */
+  static size_t estimate_size(const std::string& dir);
+
+ private:
+  using key = std::pair<std::string, int64_t>;
+
+  struct slot {
+    std::shared_future<std::shared_ptr<model>> future;
+    bool ready = false;
+    size_t bytes = 0;
+    std::list<key>::iterator lru;
+  };
+
+  // Drops ready slots, least recently used first, until the budget is met
+  // or only keep is left. Needs the mutex.
+  void evict_over_budget(const slot* keep);
+  void erase(std::map<key, std::shared_ptr<slot>>::iterator it);
+
+  const options opts;
+
+  mutable std::mutex mutex;
+  std::map<key, std::shared_ptr<slot>> slots;
+  std::list<key> lru;  // Most recently used first
+  size_t resident_bytes = 0;
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t evictions = 0;
+};  // Class model_registry
+
+}  // namespace cppflow
+
+
+/******************************
+ *   IMPLEMENTATION DETAILS   *
+ ******************************/
+
+
+namespace cppflow {
+
+inline model_registry::model_registry(size_t memory_budget)
+    : model_registry(options{memory_budget, {}, {}}) {}
+
+inline model_registry::model_registry(options opts) : opts(std::move(opts)) {}
+
+inline std::shared_ptr<model> model_registry::get(const std::string& path,
+                                                  int64_t version) {
+  const key k{path, version};
+  std::shared_ptr<slot> s;
+  std::promise<std::shared_ptr<model>> promise;
+  bool load = false;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto it = this->slots.find(k);
+    if (it != this->slots.end()) {
+      this->hits++;
+      s = it->second;
+      this->lru.splice(this->lru.begin(), this->lru, s->lru);
+    } else {
+      this->misses++;
+      s = std::make_shared<slot>();
+      s->future = promise.get_future().share();
+      s->lru = this->lru.insert(this->lru.begin(), k);
+      this->slots.emplace(k, s);
+      load = true;
+    }
+  }
+  if (!load)
+    return s->future.get();
+
+  // Load outside of the lock, other callers wait on the future
+  const std::string dir = version >= 0 ?
+      (std::filesystem::path(path) / std::to_string(version)).string() : path;
+  std::shared_ptr<model> m;
+  size_t bytes = 0;
+  try {
+    m = std::make_shared<model>(dir, this->opts.config_bytes);
+    bytes = this->opts.size_estimator ? this->opts.size_estimator(dir) :
+                                        estimate_size(dir);
+  } catch (...) {
+    {
+      // Forget the failed load, so that a later call retries it
+      std::lock_guard<std::mutex> lock(this->mutex);
+      auto it = this->slots.find(k);
+      if (it != this->slots.end() && it->second == s)
+        this->erase(it);
+    }
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    // The slot may have been evicted or cleared while loading
+    auto it = this->slots.find(k);
+    if (it != this->slots.end() && it->second == s) {
+      s->ready = true;
+      s->bytes = bytes;
+      this->resident_bytes += bytes;
+      this->evict_over_budget(s.get());
+    }
+  }
+  promise.set_value(m);
+  return m;
+}
+
+inline bool model_registry::contains(const std::string& path,
+                                     int64_t version) const {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->slots.count({path, version}) > 0;
+}
+
+inline void model_registry::evict(const std::string& path, int64_t version) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  auto it = this->slots.find({path, version});
+  if (it != this->slots.end()) {
+    this->erase(it);
+    this->evictions++;
+  }
+}
+
+inline void model_registry::clear() {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->evictions += this->slots.size();
+  this->slots.clear();
+  this->lru.clear();
+  this->resident_bytes = 0;
+}
+
+inline model_registry::stats model_registry::get_stats() const {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return {this->slots.size(), this->resident_bytes, this->hits, this->misses,
+          this->evictions};
+}
+
+inline void model_registry::erase(
+    std::map<key, std::shared_ptr<slot>>::iterator it) {
+  this->resident_bytes -= it->second->bytes;
+  this->lru.erase(it->second->lru);
+  this->slots.erase(it);
+}
+
+inline void model_registry::evict_over_budget(const slot* keep) {
+  if (this->opts.memory_budget == 0)
+    return;
+
+  auto k = this->lru.end();
+  while (this->resident_bytes > this->opts.memory_budget &&
+         k != this->lru.begin()) {
+    auto candidate = std::prev(k);
+    auto it = this->slots.find(*candidate);
+    if (it->second.get() == keep || !it->second->ready) {
+      k = candidate;
+      continue;
+    }
+    // Only candidate is erased, k stays valid
+    this->erase(it);
+    this->evictions++;
+  }
+}
+
+inline size_t model_registry::estimate_size(const std::string& dir) {
+  namespace fs = std::filesystem;
+
+  // Files whose size can not be read count as empty: file_size() returns
+  // uintmax_t(-1) on error. A directory that can not be read stops the walk
+  // with what was counted so far
+  std::error_code ec;
+  size_t bytes = 0;
+  const auto graph = fs::path(dir) / "saved_model.pb";
+  if (fs::is_regular_file(graph, ec)) {
+    const auto size = fs::file_size(graph, ec);
+    if (!ec)
+      bytes += 2 * static_cast<size_t>(size);
+  }
+
+  const auto variables = fs::path(dir) / "variables";
+  if (fs::is_directory(variables, ec)) {
+    fs::recursive_directory_iterator it(
+        variables, fs::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+      std::error_code file_ec;
+      if (!it->is_regular_file(file_ec))
+        continue;
+      const auto size = it->file_size(file_ec);
+      if (!file_ec)
+        bytes += static_cast<size_t>(size);
+    }
+  }
+  return bytes;
+}
+
+}  // namespace cppflow
+
+#endif  // INCLUDE_CPPFLOW_MODEL_REGISTRY_H_
@@ -0,0 +1,326 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/*!
+ *  @file       model_server.h
+ *  @brief      Hot reload of a versioned SavedModel directory
+ */
+
+#ifndef INCLUDE_CPPFLOW_MODEL_SERVER_H_
+#define INCLUDE_CPPFLOW_MODEL_SERVER_H_
+
+// C++ headers
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// CppFlow headers
+#include "cppflow/model.h"
+#include "cppflow/tensor.h"
+
+namespace cppflow {
+
+/**
+ * @class model_server
+ * @brief Serves the latest version of a model laid out as base/<N>/
+ *
+ * A watcher thread polls the base directory. When a higher version
+ * appears it is loaded and warmed up in the background, then swapped in.
+ * Every call runs on a snapshot (a shared_ptr) of the model that was
+ * current when it started, so in-flight calls finish on the old session.
+ * The old version is released by the watcher once the last of those calls
+ * is done, never on a caller's thread.
+ */
+class model_server {
+ public:
+  struct options {
+    // Interval between scans of the base directory, 0 disables the watcher
+    // (call poll() instead)
+    std::chrono::milliseconds poll_interval{1000};
+
+    // Serialized ConfigProto of every version
+    std::vector<uint8_t> config_bytes;
+
+    // Warm up a new version before it serves
+    bool warmup = true;
+    model::warmup_options warmup_options;
+
+    // Called after every load attempt, with a null error on success
+    std::function<void(int64_t version, std::exception_ptr error)> on_load;
+  };
+
+  /**
+   * Loads the latest version and starts watching for new ones
+   * @param base_path Directory holding one SavedModel per numeric subdirectory
+   */
+  explicit model_server(const std::string& base_path);
+  model_server(const std::string& base_path, options opts);
+
+  model_server(const model_server&) = delete;
+  model_server(model_server&&) = delete;
+
+  ~model_server();
+
+  model_server& operator=(const model_server&) = delete;
+  model_server& operator=(model_server&&) = delete;
+
+  /**
+   * @return The current model, valid for as long as it is held
+   */
+  std::shared_ptr<model> current() const;
+
+  /**
+   * @return The version of the current model
+   */
+  int64_t version() const;
+
+  std::vector<tensor> operator()(
+      const std::vector<std::tuple<std::string, tensor>>& inputs,
+      const std::vector<std::string>& outputs);
+
+  std::map<std::string, tensor> run(
+      const std::string& signature_key,
+      const std::map<std::string, tensor>& inputs);
+
+  /**
+   * Scans the base directory and loads the latest version if it is newer
+   * @return true if a new version was swapped in
+   */
+  bool poll();
+
+  /**
+   * @return The versions found in the base directory, in ascending order
+   */
+  static std::vector<int64_t> list_versions(const std::string& base_path);
+
+ private:
+  using file_time = std::filesystem::file_time_type;
+
+  void watch();
+  void release_retired();
+
+  const std::string base_path;
+  const options opts;
+
+  mutable std::mutex current_mutex;
+  std::shared_ptr<model> current_model;
+  int64_t current_version = -1;
+
+  // Serializes poll() between the watcher and explicit calls
+  std::mutex poll_mutex;
+
+  // Versions that failed to load, with the time of the SavedModel they
+  // failed on, so that they are only retried once rewritten
+  std::map<int64_t, file_time> failed;
+
+  // Replaced versions, still referenced by in-flight calls
+  std::vector<std::shared_ptr<model>> retired;
+
+  std::mutex stop_mutex;
+  std::condition_variable stop_cv;
+  bool stop = false;
+  std::thread watcher;
+};  // Class model_server
+
+}  // namespace cppflow
+
+
+/******************************
+ *   IMPLEMENTATION DETAILS   *
+ ******************************/
+
+
+namespace cppflow {
+
+inline model_server::model_server(const std::string& base_path)
+    : model_server(base_path, options()) {}
+
+inline model_server::model_server(const std::string& base_path, options opts)
+    : base_path(base_path), opts(std::move(opts)) {
+  this->poll();
+  if (!this->current_model)
+    throw std::runtime_error("No loadable model version in " + base_path);
+
+  if (this->opts.poll_interval.count() > 0)
+    this->watcher = std::thread([this] { this->watch(); });
+}
+
+inline model_server::~model_server() {
+  {
+    std::lock_guard<std::mutex> lock(this->stop_mutex);
+    this->stop = true;
+  }
+  this->stop_cv.notify_all();
+  if (this->watcher.joinable())
+    this->watcher.join();
+}
+
+inline std::shared_ptr<model> model_server::current() const {
+  std::lock_guard<std::mutex> lock(this->current_mutex);
+  return this->current_model;
+}
+
+inline int64_t model_server::version() const {
+  std::lock_guard<std::mutex> lock(this->current_mutex);
+  return this->current_version;
+}
+
+inline std::vector<tensor> model_server::operator()(
+    const std::vector<std::tuple<std::string, tensor>>& inputs,
+    const std::vector<std::string>& outputs) {
+  auto m = this->current();
+  return (*m)(inputs, outputs);
+}
+
+inline std::map<std::string, tensor> model_server::run(
+    const std::string& signature_key,
+    const std::map<std::string, tensor>& inputs) {
+  auto m = this->current();
+  return m->run(signature_key, inputs);
+}
+
+inline std::vector<int64_t> model_server::list_versions(
+    const std::string& base_path) {
+  namespace fs = std::filesystem;
+
+  std::vector<int64_t> versions;
+  std::error_code ec;
+  fs::directory_iterator it(base_path, ec);
+  for (; !ec && it != fs::directory_iterator(); it.increment(ec)) {
+    // An entry that can not be checked is skipped, not the whole listing
+    std::error_code entry_ec;
+    if (!it->is_directory(entry_ec))
+      continue;
+    const auto name = it->path().filename().string();
+    if (name.empty() ||
+        name.find_first_not_of("0123456789") != std::string::npos)
+      continue;
+    // Names too long for a version are not versions
+    int64_t version;
+    const auto [end, parse_ec] =
+        std::from_chars(name.data(), name.data() + name.size(), version);
+    if (parse_ec != std::errc() || end != name.data() + name.size())
+      continue;
+    // Only complete SavedModels, the graph is typically written last
+    if (!fs::exists(it->path() / "saved_model.pb", entry_ec))
+      continue;
+    versions.push_back(version);
+  }
+  if (ec)
+    throw std::runtime_error("Unable to list " + base_path + ": " +
+                             ec.message());
+
+  std::sort(versions.begin(), versions.end());
+  return versions;
+}
+
+inline bool model_server::poll() {
+  namespace fs = std::filesystem;
+  std::lock_guard<std::mutex> poll_lock(this->poll_mutex);
+
+  this->release_retired();
+
+  auto versions = list_versions(this->base_path);
+  const int64_t current = this->version();
+
+  // Newest first, falling back to older versions that are still newer
+  // than the current one if the newest does not load
+  for (auto v = versions.rbegin(); v != versions.rend() && *v > current; ++v) {
+    const auto dir = fs::path(this->base_path) / std::to_string(*v);
+    std::error_code ec;
+    const auto written = fs::last_write_time(dir / "saved_model.pb", ec);
+
+    auto f = this->failed.find(*v);
+    if (f != this->failed.end() && f->second == written)
+      continue;
+
+    std::shared_ptr<model> next;
+    try {
+      next = std::make_shared<model>(dir.string(), this->opts.config_bytes);
+      if (this->opts.warmup)
+        next->warmup(this->opts.warmup_options);
+    } catch (...) {
+      this->failed[*v] = written;
+      if (this->opts.on_load)
+        this->opts.on_load(*v, std::current_exception());
+      continue;
+    }
+    this->failed.erase(*v);
+
+    {
+      std::lock_guard<std::mutex> lock(this->current_mutex);
+      std::swap(this->current_model, next);
+      this->current_version = *v;
+    }
+    if (next)
+      this->retired.push_back(std::move(next));
+    this->release_retired();
+
+    if (this->opts.on_load)
+      this->opts.on_load(*v, nullptr);
+    return true;
+  }
+  return false;
+}
+
+inline void model_server::release_retired() {
+  // A retired model is no longer handed out by current(), so once the
+  // server holds the only reference no call can be using it
+  auto it = std::remove_if(this->retired.begin(), this->retired.end(),
+                           [](const std::shared_ptr<model>& m) {
+                             return m.use_count() == 1;
+                           });
+  this->retired.erase(it, this->retired.end());
+}
+
+inline void model_server::watch() {
+  std::unique_lock<std::mutex> lock(this->stop_mutex);
+  while (!this->stop_cv.wait_for(lock, this->opts.poll_interval,
+                                 [this] { return this->stop; })) {
+    lock.unlock();
+    try {
+      this->poll();
+    } catch (const std::exception&) {
+      // The base directory may be briefly unavailable, retry on next scan
+    }
+    lock.lock();
+  }
+}
+
+}  // namespace cppflow
+
+#endif  // INCLUDE_CPPFLOW_MODEL_SERVER_H_
@@ -0,0 +1,272 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/*!
+ *  @file       op_dispatch.h
+ *  @brief      Execution of eager ops, shared by all the generated ops
+ */
+
+#ifndef INCLUDE_CPPFLOW_OP_DISPATCH_H_
+#define INCLUDE_CPPFLOW_OP_DISPATCH_H_
+
+// C headers
+#include <tensorflow/c/eager/c_api.h>
+#include <tensorflow/c/eager/c_api_experimental.h>
+
+// C++ headers
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// CppFlow headers
+#include "cppflow/context.h"
+#include "cppflow/tensor.h"
+
+namespace cppflow {
+
+/**
+ * @struct op_slot
+ * @brief The TFE_Op of one generated op on one thread
+ *
+ * Every generated op has a thread_local slot, so the TFE_Op is created
+ * once per thread and reset between calls instead of being created and
+ * deleted by each of them. The slot keeps the context of its op alive, so
+ * the op is never deleted after its context, even if the global context
+ * was replaced.
+ */
+struct op_slot {
+  op_slot() = default;
+  op_slot(const op_slot&) = delete;
+  op_slot& operator=(const op_slot&) = delete;
+  ~op_slot() { this->reset(); }
+
+  // Creates the op in the global context, replacing the current one
+  void create(const char* op_name);
+  void reset();
+
+  // The context the op was created in
+  std::shared_ptr<TFE_Context> context;
+  TFE_Op* op = nullptr;
+  bool in_use = false;
+};
+
+/**
+ * @class cached_op
+ * @brief Borrows the TFE_Op of a slot for one call
+ *
+ * The op is reset when the call ends, which drops its inputs and
+ * attributes. If the slot is already in use, e.g. by a call in progress
+ * higher up the stack, a new TFE_Op is created and deleted instead. Ops
+ * created in a context that was since replaced are not reused.
+ */
+class cached_op {
+ public:
+  cached_op(op_slot& slot, const char* op_name);
+  ~cached_op();
+
+  cached_op(const cached_op&) = delete;
+  cached_op& operator=(const cached_op&) = delete;
+
+  TFE_Op* get() const { return this->op; }
+
+ private:
+  op_slot* slot = nullptr;
+  TFE_Op* op = nullptr;
+  const char* op_name;
+};  // Class cached_op
+
+/**
+ * @class small_buffer
+ * @brief Array of size elements, on the stack up to N of them
+ */
+template<typename T, size_t N = 8>
+class small_buffer {
+ public:
+  explicit small_buffer(size_t size) : size_(size) {
+    if (size > N)
+      this->heap_.reset(new T[size]);
+  }
+
+  T* data() { return this->heap_ ? this->heap_.get() : this->local_; }
+  size_t size() const { return this->size_; }
+
+ private:
+  T local_[N];
+  std::unique_ptr<T[]> heap_;
+  size_t size_;
+};  // Class small_buffer
+
+/**
+ * @class op_recorder
+ * @brief Sees every op executed on its thread while it is current
+ *
+ * Used by cppflow::function to record the ops of its body into a graph.
+ */
+class op_recorder {
+ public:
+  virtual ~op_recorder() = default;
+
+  /**
+   * Called after op has run
+   * @param op The op, with its inputs and attributes
+   * @param outputs The outputs of the op
+   * @param num_outputs Number of outputs
+   */
+  virtual void record(TFE_Op* op, const tensor* outputs, int num_outputs) = 0;
+
+  /**
+   * @return The recorder of the calling thread, null if none
+   */
+  static op_recorder*& current();
+};  // Class op_recorder
+
+/**
+ * Executes an op with a single output
+ * @param op An op with all its inputs and attributes set
+ */
+tensor execute_op(TFE_Op* op);
+
+/**
+ * Executes an op
+ * @param op An op with all its inputs and attributes set
+ * @param num_outputs The number of outputs of the op
+ */
+std::vector<tensor> execute_op(TFE_Op* op, int num_outputs);
+
+/**
+ * Executes an op with a fixed number of outputs
+ * @tparam N The number of outputs of the op
+ * @param op An op with all its inputs and attributes set
+ */
+template<size_t N>
+std::array<tensor, N> execute_op(TFE_Op* op);
+
+}  // namespace cppflow
+
+
+/******************************
+ *   IMPLEMENTATION DETAILS   *
+ ******************************/
+
+
+namespace cppflow {
+
+inline void op_slot::create(const char* op_name) {
+  this->reset();
+  auto ctx = context::get_shared_context();
+  this->op = TFE_NewOp(ctx.get(), op_name, context::get_status());
+  status_check(context::get_status());
+  this->context = std::move(ctx);
+}
+
+inline void op_slot::reset() {
+  if (this->op)
+    TFE_DeleteOp(this->op);
+  this->op = nullptr;
+  this->context.reset();
+}
+
+inline cached_op::cached_op(op_slot& slot, const char* op_name)
+    : op_name(op_name) {
+  if (slot.in_use) {
+    this->op = TFE_NewOp(context::get_context(), op_name,
+                         context::get_status());
+    status_check(context::get_status());
+    return;
+  }
+
+  if (!slot.op || slot.context.get() != context::get_context())
+    slot.create(op_name);
+
+  slot.in_use = true;
+  this->slot = &slot;
+  this->op = slot.op;
+}
+
+inline cached_op::~cached_op() {
+  if (!this->slot) {
+    TFE_DeleteOp(this->op);
+    return;
+  }
+
+  // Reset now rather than on the next call, so that the inputs are not
+  // kept alive by the slot
+  TFE_OpReset(this->op, this->op_name, "", context::get_status());
+  if (TF_GetCode(context::get_status()) != TF_OK) {
+    TFE_DeleteOp(this->op);
+    this->slot->op = nullptr;
+  }
+  this->slot->in_use = false;
+}
+
+inline op_recorder*& op_recorder::current() {
+  thread_local op_recorder* recorder = nullptr;
+  return recorder;
+}
+
+inline tensor execute_op(TFE_Op* op) {
+  int num_outputs = 1;
+  TFE_TensorHandle* res[1] = {nullptr};
+  TFE_Execute(op, res, &num_outputs, context::get_status());
+  status_check(context::get_status());
+
+  tensor result(res[0]);
+  if (auto* recorder = op_recorder::current())
+    recorder->record(op, &result, 1);
+  return result;
+}
+
+inline std::vector<tensor> execute_op(TFE_Op* op, int num_outputs) {
+  std::vector<TFE_TensorHandle*> res(num_outputs, nullptr);
+  TFE_Execute(op, res.data(), &num_outputs, context::get_status());
+  status_check(context::get_status());
+
+  std::vector<tensor> result;
+  result.reserve(num_outputs);
+  for (int i = 0; i < num_outputs; i++)
+    result.emplace_back(res[i]);
+  if (auto* recorder = op_recorder::current())
+    recorder->record(op, result.data(), num_outputs);
+  return result;
+}
+
+template<size_t N>
+std::array<tensor, N> execute_op(TFE_Op* op) {
+  int num_outputs = N;
+  std::array<TFE_TensorHandle*, N> res{};
+  TFE_Execute(op, res.data(), &num_outputs, context::get_status());
+  status_check(context::get_status());
+
+  std::array<tensor, N> result;
+  for (size_t i = 0; i < N; i++)
+    result[i] = tensor(res[i]);
+  if (auto* recorder = op_recorder::current())
+    recorder->record(op, result.data(), static_cast<int>(N));
+  return result;
+}
+
+}  // namespace cppflow
+
+#endif  // INCLUDE_CPPFLOW_OP_DISPATCH_H_
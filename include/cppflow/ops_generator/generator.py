@@ -137,19 +137,25 @@ class Attribute:
         if self.islist:
             return textwrap.dedent({
                 'string' : '''
-                            std::vector<std::size_t> {0}_sizes; {0}_sizes.reserve({0}.size());
-                            std::transform({0}.begin(), {0}.end(), std::back_inserter({0}_sizes), [](const auto& s) {{ return s.size();}});
-                            TFE_OpSetAttrStringList(op.get(), "{orig:}", reinterpret_cast<const void *const *>({0}.data()), {0}_sizes.data(), static_cast<int>({0}.size()));
+                            small_buffer<const void*> {0}_values({0}.size());
+                            small_buffer<std::size_t> {0}_sizes({0}.size());
+                            std::transform({0}.begin(), {0}.end(), {0}_values.data(), [](const auto& s) {{ return static_cast<const void*>(s.data());}});
+                            std::transform({0}.begin(), {0}.end(), {0}_sizes.data(), [](const auto& s) {{ return s.size();}});
+                            TFE_OpSetAttrStringList(op.get(), "{orig:}", {0}_values.data(), {0}_sizes.data(), static_cast<int>({0}.size()));
                             ''',
                 'int'    : 'TFE_OpSetAttrIntList(op.get(), "{orig:}", {0}.data(), static_cast<int>({0}.size()));',
                 'float'  : 'TFE_OpSetAttrFloatList(op.get(), "{orig:}", {0}.data(), static_cast<int>({0}.size()));',
-                'bool'   : 'TFE_OpSetAttrBoolList(op.get(), "{orig:}", std::vector<unsigned char>({0}.begin(), {0}.end()).data(), {0}.size());',
+                'bool'   : '''
+                            small_buffer<unsigned char> {0}_values({0}.size());
+                            std::copy({0}.begin(), {0}.end(), {0}_values.data());
+                            TFE_OpSetAttrBoolList(op.get(), "{orig:}", {0}_values.data(), static_cast<int>({0}.size()));
+                            ''',
                 'type'   : 'TFE_OpSetAttrTypeList(op.get(), "{orig:}", reinterpret_cast<const enum TF_DataType *>({0}.data()), static_cast<int>({0}.size()));',
                 'shape'  : '''
-                            std::vector<const int64_t*> {0}_values; {0}_values.reserve({0}.size());
-                            std::vector<int> {0}_ndims; {0}_ndims.reserve({0}.size());
-                            std::transform({0}.begin(), {0}.end(), std::back_inserter({0}_values), [](const auto& v) {{ return v.data();}});
-                            std::transform({0}.begin(), {0}.end(), std::back_inserter({0}_ndims), [](const auto& v) {{ return static_cast<int>(v.size());}});
+                            small_buffer<const int64_t*> {0}_values({0}.size());
+                            small_buffer<int> {0}_ndims({0}.size());
+                            std::transform({0}.begin(), {0}.end(), {0}_values.data(), [](const auto& v) {{ return v.data();}});
+                            std::transform({0}.begin(), {0}.end(), {0}_ndims.data(), [](const auto& v) {{ return static_cast<int>(v.size());}});
                             TFE_OpSetAttrShapeList(op.get(), "{orig:}", {0}_values.data(), {0}_ndims.data(), static_cast<int>({0}.size()), context::get_status());
                             status_check(context::get_status());
                             ''',
@@ -194,11 +200,8 @@ class Operation:
     def __init__(self, op):
         self.op = op
 
-        # More than one output?
-        if len(self.op.output_arg) != 1:
-            raise Exception('More than one or no output not yet supported')
-
         self.inputs = [inp for inp in op.input_arg]
+        self.outputs = [out for out in op.output_arg]
 
         # Number attributes define the length of an input list
         number_attr = [
@@ -211,6 +214,55 @@ class Operation:
             Attribute(a, number_attr) for a in self.op.attr
         ], key=lambda a: a.default)
 
+        # Fail now rather than while generating the code
+        self.execute_code()
+
+
+    def output_count(self, out):
+        """C++ expression of the number of tensors of an output arg."""
+
+        # Lists sized like an input list are as long as that input
+        for attr in [out.number_attr, out.type_list_attr]:
+            if len(attr) == 0: continue
+            for inp in self.inputs:
+                if attr in [inp.number_attr, inp.type_list_attr]:
+                    return '{}.size()'.format(inp.name)
+
+        # Otherwise the attribute is an argument of the function
+        if len(out.number_attr):
+            return out.number_attr.replace('template', 'template_arg')
+        if len(out.type_list_attr):
+            if out.type_list_attr == 'T':
+                raise Exception('Number of outputs unknown')
+            return '{}.size()'.format(
+                out.type_list_attr.replace('template', 'template_arg'))
+        return '1'
+
+    def execute_code(self):
+        """Return type of the function and the code executing the op."""
+
+        is_list = [len(o.number_attr) or len(o.type_list_attr)
+                   for o in self.outputs]
+
+        # No output
+        if len(self.outputs) == 0:
+            return 'void', 'execute_op(op.get(), 0);'
+
+        # A single tensor
+        if len(self.outputs) == 1 and not any(is_list):
+            return 'tensor', 'return execute_op(op.get());'
+
+        # A fixed number of tensors
+        if not any(is_list):
+            return ('std::array<tensor, {}>'.format(len(self.outputs)),
+                    'return execute_op<{}>(op.get());'
+                    .format(len(self.outputs)))
+
+        # A number of tensors known from the attributes or the inputs
+        count = ' + '.join(self.output_count(o) for o in self.outputs)
+        return ('std::vector<tensor>',
+                'return execute_op(op.get(), static_cast<int>({}));'
+                .format(count))
 
     def code(self):
 
@@ -219,9 +271,9 @@ class Operation:
         {}
         inline {} {}({}{}) {{
 
-            // Define Op
-            std::unique_ptr<TFE_Op, decltype(&TFE_DeleteOp)> op(TFE_NewOp(context::get_context(), "{}", context::get_status()), &TFE_DeleteOp);
-            status_check(context::get_status());
+            // Define Op, reusing the TFE_Op of this thread
+            thread_local op_slot slot;
+            cached_op op(slot, "{}");
 
             // Required input arguments
             {}
@@ -230,34 +282,35 @@ class Operation:
             {}
 
             // Execute Op
-            int num_outputs_op = 1;
-            TFE_TensorHandle* res[1] = {{nullptr}};
-            TFE_Execute(op.get(), res, &num_outputs_op, context::get_status());
-            status_check(context::get_status());
-            return tensor(res[0]);
+            {}
         }}
         ''')
 
         # Add single input template
         add_inputs = textwrap.dedent('''
-            TFE_OpAddInput(op.get(), {}.tfe_handle.get(), context::get_status());
+            TFE_OpAddInput(op.get(), {}.get_eager_handle().get(), context::get_status());
             status_check(context::get_status());
         ''').replace('\n', '\n    ')
 
         add_inputs_list = textwrap.dedent('''
-            std::vector<TFE_TensorHandle*> {0}_handles; {0}_handles.reserve({0}.size());
-            std::transform({0}.begin(), {0}.end(), std::back_inserter({0}_handles), [](const auto& t) {{ return t.tfe_handle.get();}});
+            small_buffer<TFE_TensorHandle*> {0}_handles({0}.size());
+            std::transform({0}.begin(), {0}.end(), {0}_handles.data(), [](const auto& t) {{ return t.get_eager_handle().get();}});
             TFE_OpAddInputList(op.get(), {0}_handles.data(), static_cast<int>({0}.size()), context::get_status());
             status_check(context::get_status());
         ''').replace('\n', '\n    ')
 
         # Return type of the function
-        out = 'tensor' if len(self.op.output_arg) else 'void'
+        out, exe_code = self.execute_code()
 
         # snake_case name of the operation
         snk = (re.sub(r'(?<!^)(?=[A-Z])', '_', self.op.name).lower()
                .replace('const', 'const_tensor'))
 
+        # C++ keywords, standard macros and C library functions
+        old_snk = snk
+        if snk in ['abort', 'assert', 'exit', 'switch']:
+            snk += '_op'
+
         # Required input arguments
         inp = ', '.join([
             'const std::vector<tensor>&{}'.format(n.name)
@@ -285,7 +338,23 @@ class Operation:
         atr_code = '\n    '.join(a.code() for a in self.attr_list
                                  if len(a.code()))
 
-        return template.format('', out, snk, inp, atr, opn, inp_code, atr_code)
+        code = template.format('', out, snk, inp, atr, opn, inp_code, atr_code,
+                               exe_code)
+
+        # Names of released ops that took the suffix, kept as aliases
+        if old_snk in ['exit']:
+            args = ', '.join(
+                [n.name.replace('tensor', 'input_tensor') for n in self.inputs] +
+                [a.name.replace('template', 'template_arg')
+                 for a in self.attr_list if len(a.declaration())])
+            code += textwrap.dedent('''
+            [[deprecated("Use {1}")]]
+            inline {2} {0}({3}{4}) {{
+                return {1}({5});
+            }}
+            ''').format(old_snk, snk, out, inp, atr, args)
+
+        return code
 
 
 
@@ -330,6 +399,7 @@ ops_file = textwrap.dedent('''
 #include <tensorflow/c/tf_tensor.h>
 
 // C++ headers
+#include <array>
 #include <cstdint>
 #include <vector>
 #include <limits>
@@ -338,6 +408,7 @@ ops_file = textwrap.dedent('''
 // CppFlow headers
 #include "cppflow/tensor.h"
 #include "cppflow/datatype.h"
+#include "cppflow/op_dispatch.h"
 
 namespace cppflow {{
 
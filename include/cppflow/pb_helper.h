@@ -4,9 +4,13 @@
 
 #ifndef CPPFLOW_PB_HELPER_H
 #define CPPFLOW_PB_HELPER_H
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <utility>
 #include <vector>
 #include <map>
+#include <optional>
 #include <iostream>
 
 #include <tensorflow/c/c_api.h>
@@ -16,8 +20,9 @@ namespace cppflow {
 
     struct TensorInfo {
         std::string name;
-        datatype dtype;              // TF DataType Enum (e.g., TF_FLOAT, TF_INT32)
-        std::vector<int64_t> shape; // Dimensions (Empty usually means scalar or unknown)
+        datatype dtype = static_cast<datatype>(0); // TF DataType Enum (e.g., TF_FLOAT, TF_INT32), 0 if unset
+        std::vector<int64_t> shape; // Dimensions (-1 for unknown dims)
+        bool unknown_rank = true;    // Set when the shape is missing or has unknown_rank
     };
 
     struct Signature {
@@ -41,22 +46,26 @@ namespace cppflow {
 
         bool eof() const { return ptr_ >= end_; }
 
-        // Read Varint (Base-128)
+        // Current read position, e.g. to copy a field verbatim after skip()
+        const uint8_t* position() const { return ptr_; }
+
+        // Read Varint (Base-128), at most 10 bytes
         uint64_t read_varint() {
             uint64_t val = 0;
-            int shift = 0;
-            while (ptr_ < end_) {
+            for (int shift = 0; shift < 64 && ptr_ < end_; shift += 7) {
                 uint8_t b = *ptr_++;
                 val |= static_cast<uint64_t>(b & 0x7F) << shift;
                 if (!(b & 0x80)) break;
-                shift += 7;
             }
             return val;
         }
 
         // Read N bytes as a string (Raw Data)
-        std::string read_bytes(size_t len) {
-            if (ptr_ + len > end_) return ""; // Safety check
+        std::string read_bytes(uint64_t len) {
+            if (len > static_cast<uint64_t>(end_ - ptr_)) { // Truncated
+                ptr_ = end_;
+                return "";
+            }
             std::string s(reinterpret_cast<const char*>(ptr_), len);
             ptr_ += len;
             return s;
@@ -73,14 +82,175 @@ namespace cppflow {
             if (wire_type == 0) { // Varint
                 read_varint();
             } else if (wire_type == 2) { // Length Delimited
-                uint64_t len = read_varint();
-                ptr_ += len;
+                advance(read_varint());
             } else if (wire_type == 5) { // 32-bit
-                ptr_ += 4;
+                advance(4);
             } else if (wire_type == 1) { // 64-bit
-                ptr_ += 8;
+                advance(8);
             }
         }
+
+    private:
+        // Move past len bytes, or to the end if fewer are left
+        void advance(uint64_t len) {
+            if (len > static_cast<uint64_t>(end_ - ptr_))
+                ptr_ = end_;
+            else
+                ptr_ += len;
+        }
+    };
+
+    // A minimal Protobuf wire-format writer
+    // Fields written later override earlier scalar fields with the same
+    // number, so a writer can start from existing bytes and amend them.
+    class ProtoWriter {
+        std::vector<uint8_t> data_;
+
+    public:
+        ProtoWriter() = default;
+
+        explicit ProtoWriter(std::vector<uint8_t> data)
+            : data_(std::move(data)) {}
+
+        const std::vector<uint8_t>& data() const { return data_; }
+
+        // Append already encoded fields
+        void write_raw(const std::string& bytes) {
+            data_.insert(data_.end(), bytes.begin(), bytes.end());
+        }
+        bool empty() const { return data_.empty(); }
+
+        // Write Varint (Base-128), negative values take 10 bytes
+        void write_varint(uint64_t val) {
+            while (val >= 0x80) {
+                data_.push_back(static_cast<uint8_t>(val | 0x80));
+                val >>= 7;
+            }
+            data_.push_back(static_cast<uint8_t>(val));
+        }
+
+        void write_tag(uint32_t field, uint32_t wire_type) {
+            write_varint((static_cast<uint64_t>(field) << 3) | wire_type);
+        }
+
+        // int32, int64, enum (Wire type 0)
+        void write_int(uint32_t field, int64_t val) {
+            write_tag(field, 0);
+            write_varint(static_cast<uint64_t>(val));
+        }
+
+        // bool (Wire type 0)
+        void write_bool(uint32_t field, bool val) {
+            write_int(field, val ? 1 : 0);
+        }
+
+        // double (Wire type 1, little endian)
+        void write_double(uint32_t field, double val) {
+            uint64_t bits;
+            std::memcpy(&bits, &val, sizeof(bits));
+            write_tag(field, 1);
+            for (int i = 0; i < 8; i++)
+                data_.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+        }
+
+        // string, bytes (Wire type 2)
+        void write_bytes(uint32_t field, const void* ptr, size_t len) {
+            write_tag(field, 2);
+            write_varint(len);
+            const auto* bytes = static_cast<const uint8_t*>(ptr);
+            data_.insert(data_.end(), bytes, bytes + len);
+        }
+
+        void write_string(uint32_t field, const std::string& val) {
+            write_bytes(field, val.data(), val.size());
+        }
+
+        // Nested message (Wire type 2)
+        void write_message(uint32_t field, const ProtoWriter& msg) {
+            write_bytes(field, msg.data_.data(), msg.data_.size());
+        }
+    };
+
+    // Typed builder for the "ConfigProto" passed to TF_SetConfig
+    // Only the fields that were set are written. It converts to the raw
+    // config bytes, so it can be passed wherever config_bytes are taken:
+    //   cppflow::model model(path, cppflow::session_config()
+    //                                  .intra_op_parallelism_threads(4)
+    //                                  .global_jit_level(cppflow::session_config::ON_1));
+    class session_config {
+    public:
+        // OptimizerOptions.Level
+        enum optimizer_level { L1 = 0, L0 = -1 };
+
+        // OptimizerOptions.GlobalJitLevel
+        enum jit_level { DEFAULT = 0, OFF = -1, ON_1 = 1, ON_2 = 2 };
+
+        session_config() = default;
+
+        // Start from existing serialized bytes, fields set here override them
+        explicit session_config(std::vector<uint8_t> base)
+            : base_(std::move(base)) {}
+
+        session_config& intra_op_parallelism_threads(int n) { intra_op_ = n; return *this; }
+        session_config& inter_op_parallelism_threads(int n) { inter_op_ = n; return *this; }
+        session_config& use_per_session_threads(bool v) { per_session_threads_ = v; return *this; }
+        session_config& allow_soft_placement(bool v) { soft_placement_ = v; return *this; }
+        session_config& log_device_placement(bool v) { log_placement_ = v; return *this; }
+
+        // graph_options.optimizer_options
+        session_config& opt_level(optimizer_level level) { opt_level_ = level; return *this; }
+        session_config& global_jit_level(jit_level level) { jit_level_ = level; return *this; }
+        session_config& do_constant_folding(bool v) { constant_folding_ = v; return *this; }
+        session_config& do_function_inlining(bool v) { function_inlining_ = v; return *this; }
+
+        // gpu_options
+        session_config& gpu_allow_growth(bool v) { allow_growth_ = v; return *this; }
+        session_config& gpu_memory_fraction(double v) { memory_fraction_ = v; return *this; }
+
+        std::vector<uint8_t> to_bytes() const {
+            ProtoWriter config(base_);
+            if (intra_op_) config.write_int(2, *intra_op_);                 // intra_op_parallelism_threads
+            if (inter_op_) config.write_int(5, *inter_op_);                 // inter_op_parallelism_threads
+            if (soft_placement_) config.write_bool(7, *soft_placement_);    // allow_soft_placement
+            if (log_placement_) config.write_bool(8, *log_placement_);      // log_device_placement
+            if (per_session_threads_) config.write_bool(9, *per_session_threads_); // use_per_session_threads
+
+            // ConfigProto -> GraphOptions (10) -> OptimizerOptions (3)
+            ProtoWriter optimizer;
+            if (constant_folding_) optimizer.write_bool(2, *constant_folding_);   // do_constant_folding
+            if (opt_level_) optimizer.write_int(3, *opt_level_);                  // opt_level
+            if (function_inlining_) optimizer.write_bool(4, *function_inlining_); // do_function_inlining
+            if (jit_level_) optimizer.write_int(5, *jit_level_);                  // global_jit_level
+            if (!optimizer.empty()) {
+                ProtoWriter graph_options;
+                graph_options.write_message(3, optimizer);
+                config.write_message(10, graph_options);
+            }
+
+            // ConfigProto -> GPUOptions (6)
+            ProtoWriter gpu;
+            if (memory_fraction_) gpu.write_double(1, *memory_fraction_); // per_process_gpu_memory_fraction
+            if (allow_growth_) gpu.write_bool(4, *allow_growth_);         // allow_growth
+            if (!gpu.empty()) config.write_message(6, gpu);
+
+            return config.data();
+        }
+
+        operator std::vector<uint8_t>() const { return to_bytes(); }
+
+    private:
+        std::vector<uint8_t> base_;
+        std::optional<int> intra_op_;
+        std::optional<int> inter_op_;
+        std::optional<bool> per_session_threads_;
+        std::optional<bool> soft_placement_;
+        std::optional<bool> log_placement_;
+        std::optional<int> opt_level_;
+        std::optional<int> jit_level_;
+        std::optional<bool> constant_folding_;
+        std::optional<bool> function_inlining_;
+        std::optional<bool> allow_growth_;
+        std::optional<double> memory_fraction_;
     };
 
     // Helper: Parse "TensorShapeProto" to get dimensions
@@ -117,6 +287,22 @@ namespace cppflow {
         return dims;
     }
 
+    // Helper: Check the "unknown_rank" flag of a "TensorShapeProto" (Field 3)
+    inline bool IsUnknownRank(const std::string& blob) {
+        ProtoReader reader(blob);
+        bool unknown_rank = false;
+
+        while (!reader.eof()) {
+            uint64_t tag = reader.read_varint();
+            if ((tag >> 3) == 3 && (tag & 7) == 0) {
+                unknown_rank = reader.read_varint() != 0;
+            } else {
+                reader.skip(tag & 7);
+            }
+        }
+        return unknown_rank;
+    }
+
     // Helper: Parse a "TensorInfo" message
     inline TensorInfo ParseTensorInfo(const std::string& blob) {
         ProtoReader reader(blob);
@@ -130,7 +316,9 @@ namespace cppflow {
             } else if (field == 2) { // Field 2: Dtype (Enum/Varint)
                 info.dtype = static_cast<datatype>(reader.read_varint());
             } else if (field == 3) { // Field 3: TensorShape (Nested)
-                info.shape = ParseTensorShape(reader.read_string());
+                std::string shape_blob = reader.read_string();
+                info.shape = ParseTensorShape(shape_blob);
+                info.unknown_rank = IsUnknownRank(shape_blob);
             } else {
                 reader.skip(tag & 7);
             }
@@ -212,5 +400,140 @@ namespace cppflow {
         return signatures;
     }
 
+    struct NodeExecStats {
+        std::string node_name;
+        std::string op;            // Op type, taken from the timeline label
+        uint32_t thread_id = 0;
+        int64_t start_nanos = 0;   // Absolute start of the node
+        int64_t op_start_rel_nanos = 0;
+        int64_t op_end_rel_nanos = 0;
+        int64_t all_end_rel_nanos = 0;
+    };
+
+    struct DeviceStepStats {
+        std::string device;
+        std::vector<NodeExecStats> nodes;
+    };
+
+    // Helper: Parse a "NodeExecStats" message
+    // Recent TF versions fill the *_nanos fields, older ones only *_micros
+    inline NodeExecStats ParseNodeExecStats(const std::string& blob) {
+        ProtoReader reader(blob);
+        NodeExecStats node;
+        int64_t micros[4] = {0, 0, 0, 0};
+        int64_t nanos[4] = {0, 0, 0, 0};
+        std::string label;
+
+        while (!reader.eof()) {
+            uint64_t tag = reader.read_varint();
+            uint32_t field = tag >> 3;
+
+            if (field == 1) {                    // node_name
+                node.node_name = reader.read_string();
+            } else if (field >= 2 && field <= 5 && (tag & 7) == 0) {
+                // all_start_micros, op_start_rel_micros, op_end_rel_micros, all_end_rel_micros
+                micros[field - 2] = static_cast<int64_t>(reader.read_varint());
+            } else if (field == 8) {             // timeline_label
+                label = reader.read_string();
+            } else if (field == 10) {            // thread_id
+                node.thread_id = static_cast<uint32_t>(reader.read_varint());
+            } else if (field >= 13 && field <= 16 && (tag & 7) == 0) {
+                // all_start_nanos, op_start_rel_nanos, op_end_rel_nanos, all_end_rel_nanos
+                nanos[field - 13] = static_cast<int64_t>(reader.read_varint());
+            } else {
+                reader.skip(tag & 7);
+            }
+        }
+
+        bool has_nanos = nanos[0] != 0;
+        node.start_nanos = has_nanos ? nanos[0] : micros[0] * 1000;
+        node.op_start_rel_nanos = has_nanos ? nanos[1] : micros[1] * 1000;
+        node.op_end_rel_nanos = has_nanos ? nanos[2] : micros[2] * 1000;
+        node.all_end_rel_nanos = has_nanos ? nanos[3] : micros[3] * 1000;
+
+        // Label format: "node_name = OpType(inputs)"
+        auto eq = label.find(" = ");
+        if (eq != std::string::npos) {
+            auto paren = label.find('(', eq);
+            node.op = label.substr(eq + 3, paren == std::string::npos ?
+                                           std::string::npos : paren - eq - 3);
+        }
+        return node;
+    }
+
+    // Parse the "StepStats" (Field 1) of a "RunMetadata" message
+    // StepStats -> Field 1 is "repeated DeviceStepStats dev_stats"
+    // DeviceStepStats -> Field 1 is "device", Field 2 is "repeated NodeExecStats"
+    inline std::vector<DeviceStepStats> ParseRunMetadataStepStats(const std::string& blob) {
+        std::vector<DeviceStepStats> devices;
+        ProtoReader reader(blob);
+
+        while (!reader.eof()) {
+            uint64_t tag = reader.read_varint();
+            if ((tag >> 3) != 1 || (tag & 7) != 2) {
+                reader.skip(tag & 7);
+                continue;
+            }
+
+            std::string step_blob = reader.read_string();
+            ProtoReader step_reader(step_blob);
+            while (!step_reader.eof()) {
+                uint64_t s_tag = step_reader.read_varint();
+                if ((s_tag >> 3) != 1 || (s_tag & 7) != 2) {
+                    step_reader.skip(s_tag & 7);
+                    continue;
+                }
+
+                DeviceStepStats device;
+                std::string dev_blob = step_reader.read_string();
+                ProtoReader dev_reader(dev_blob);
+                while (!dev_reader.eof()) {
+                    uint64_t d_tag = dev_reader.read_varint();
+                    uint32_t d_field = d_tag >> 3;
+                    if (d_field == 1) device.device = dev_reader.read_string();
+                    else if (d_field == 2) device.nodes.push_back(ParseNodeExecStats(dev_reader.read_string()));
+                    else dev_reader.skip(d_tag & 7);
+                }
+                devices.push_back(std::move(device));
+            }
+        }
+        return devices;
+    }
+
+    // Check for TensorFlow's memmapped package format (convert_graphdef_memmapped_format)
+    // The file ends with a "MemmappedFileSystemDirectory" followed by its
+    // offset as a little-endian uint64. Directory -> Field 1 is "repeated
+    // Element element", Element -> Field 2 is "name"
+    inline bool IsMemmappedPackage(const uint8_t* data, size_t size) {
+        if (size < sizeof(uint64_t)) return false;
+
+        uint64_t offset = 0;
+        for (int i = 7; i >= 0; i--) {
+            offset = (offset << 8) | data[size - sizeof(uint64_t) + i];
+        }
+        if (offset >= size - sizeof(uint64_t)) return false;
+
+        ProtoReader dir(data + offset, size - sizeof(uint64_t) - offset);
+        while (!dir.eof()) {
+            uint64_t tag = dir.read_varint();
+            if ((tag >> 3) == 1 && (tag & 7) == 2) {
+                std::string element_blob = dir.read_string();
+                ProtoReader element(element_blob);
+                while (!element.eof()) {
+                    uint64_t t = element.read_varint();
+                    if ((t >> 3) == 2 && (t & 7) == 2) {
+                        if (element.read_string().rfind("memmapped_package://", 0) == 0)
+                            return true;
+                    } else {
+                        element.skip(t & 7);
+                    }
+                }
+            } else {
+                dir.skip(tag & 7);
+            }
+        }
+        return false;
+    }
+
 } // namespace cppflow
 #endif //CPPFLOW_PB_HELPER_H
\ No newline at end of file
@@ -0,0 +1,473 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/*!
+ *  @file       result_cache.h
+ *  @brief      Content-addressed cache of model results
+ */
+
+#ifndef INCLUDE_CPPFLOW_RESULT_CACHE_H_
+#define INCLUDE_CPPFLOW_RESULT_CACHE_H_
+
+// C headers
+#include <tensorflow/c/c_api.h>
+#include <tensorflow/c/tf_tstring.h>
+
+// C++ headers
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// CppFlow headers
+#include "cppflow/model.h"
+#include "cppflow/tensor.h"
+
+namespace cppflow {
+
+/**
+ * @class result_cache
+ * @brief LRU cache of the outputs of a model, keyed by its inputs
+ *
+ * The key is a 128-bit hash of the input and output names and of the
+ * dtype, shape and bytes of every input. Entries also keep these bytes,
+ * which are compared on a hit, so a hash collision is a miss and never
+ * returns the outputs of another call; they count in the cache size. A hit
+ * returns tensors sharing the cached buffers, which must not be written
+ * to. Concurrent calls with the same key run the model once, the others
+ * wait for its result.
+ */
+class result_cache {
+ public:
+  struct options {
+    // Total size of the cached outputs and of the inputs they are keyed by
+    size_t max_bytes = size_t(256) << 20;
+
+    // Age after which an entry is recomputed, 0 for no limit
+    std::chrono::milliseconds ttl{0};
+  };
+
+  struct stats {
+    size_t hits;
+    size_t misses;
+    size_t coalesced;  // Calls that waited for an identical one
+    size_t evictions;
+    size_t entries;
+    size_t bytes;
+
+    // (hits + coalesced) / calls
+    double hit_rate;
+
+    // Model time the hits and coalesced calls did not spend
+    double saved_seconds;
+  };
+
+  explicit result_cache(const model& m);
+  result_cache(const model& m, options opts);
+
+  result_cache(const result_cache&) = delete;
+  result_cache& operator=(const result_cache&) = delete;
+
+  /**
+   * Returns the cached outputs, or runs the model and caches them
+   */
+  std::vector<tensor> operator()(
+      const std::vector<std::tuple<std::string, tensor>>& inputs,
+      const std::vector<std::string>& outputs);
+
+  stats get_stats() const;
+  void clear();
+
+  struct key {
+    uint64_t lo;
+    uint64_t hi;
+    bool operator<(const key& other) const {
+      return lo != other.lo ? lo < other.lo : hi < other.hi;
+    }
+  };
+
+  /**
+   * @return The cache key of a call
+   */
+  static key hash(const std::vector<std::tuple<std::string, tensor>>& inputs,
+                  const std::vector<std::string>& outputs);
+
+ private:
+  using clock = std::chrono::steady_clock;
+
+  struct value {
+    std::shared_ptr<const std::string> request;  // See request_bytes()
+    std::vector<tensor> outputs;
+    double seconds;  // Time the model took
+  };
+
+  struct pending_call {
+    std::shared_ptr<const std::string> request;
+    std::shared_future<std::shared_ptr<const value>> result;
+  };
+
+  // Calls f(data, size) on the names, dtypes, shapes and bytes of a call,
+  // strings preceded by their size, so the pieces are unambiguous
+  template <typename F>
+  static void for_each_piece(
+      const std::vector<std::tuple<std::string, tensor>>& inputs,
+      const std::vector<std::string>& outputs, F&& f);
+
+  // The pieces of a call, concatenated
+  static std::string request_bytes(
+      const std::vector<std::tuple<std::string, tensor>>& inputs,
+      const std::vector<std::string>& outputs);
+
+  // Whether request holds the pieces of this call
+  static bool same_request(
+      const std::string& request,
+      const std::vector<std::tuple<std::string, tensor>>& inputs,
+      const std::vector<std::string>& outputs);
+
+  struct entry {
+    std::shared_ptr<const value> v;
+    size_t bytes;
+    clock::time_point expires;
+    std::list<key>::iterator lru;
+  };
+
+  void erase(std::map<key, entry>::iterator it);
+
+  model m;
+  const options opts;
+
+  mutable std::mutex mutex;
+  std::map<key, entry> entries;
+  std::map<key, pending_call> pending;
+  std::list<key> lru;  // Most recently used first
+  size_t bytes = 0;
+
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t coalesced = 0;
+  size_t evictions = 0;
+  double saved_seconds = 0.0;
+};  // Class result_cache
+
+}  // namespace cppflow
+
+
+/******************************
+ *   IMPLEMENTATION DETAILS   *
+ ******************************/
+
+
+namespace cppflow {
+
+namespace detail {
+
+// Two independent 64-bit lanes over 16-byte blocks, so the multiplies of
+// both overlap; finalized with the murmur3 mixer
+class hash128 {
+ public:
+  void update(const void* data, size_t len) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+      uint64_t w0, w1;
+      std::memcpy(&w0, p + i, 8);
+      std::memcpy(&w1, p + i + 8, 8);
+      a = round(a, w0);
+      b = round(b, w1);
+    }
+    uint64_t tail[2] = {0, 0};
+    if (len > i)
+      std::memcpy(tail, p + i, len - i);
+    a = round(a, tail[0]);
+    b = round(b, tail[1]);
+    a = round(a, len);
+  }
+
+  result_cache::key digest() const {
+    uint64_t x = fmix(a ^ (b >> 1));
+    uint64_t y = fmix(b ^ (a << 1) ^ 0x94D049BB133111EBull);
+    return {x, y};
+  }
+
+ private:
+  static uint64_t round(uint64_t h, uint64_t w) {
+    h ^= w * 0x87C37B91114253D5ull;
+    h = (h << 31) | (h >> 33);
+    return h * 0x4CF5AD432745937Full + 0x52DCE729;
+  }
+
+  static uint64_t fmix(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xFF51AFD7ED558CCDull;
+    k ^= k >> 33;
+    k *= 0xC4CEB9FE1A85EC53ull;
+    k ^= k >> 33;
+    return k;
+  }
+
+  uint64_t a = 0x9E3779B97F4A7C15ull;
+  uint64_t b = 0xC2B2AE3D27D4EB4Full;
+};
+
+}  // namespace detail
+
+inline result_cache::result_cache(const model& m)
+    : result_cache(m, options()) {}
+
+inline result_cache::result_cache(const model& m, options opts)
+    : m(m), opts(opts) {}
+
+template <typename F>
+void result_cache::for_each_piece(
+    const std::vector<std::tuple<std::string, tensor>>& inputs,
+    const std::vector<std::string>& outputs, F&& f) {
+  const auto put_int = [&f](uint64_t v) { f(&v, sizeof(v)); };
+  const auto put_string = [&](const void* data, size_t len) {
+    put_int(len);
+    f(data, len);
+  };
+
+  put_int(inputs.size());
+  for (const auto& [name, value] : inputs) {
+    put_string(name.data(), name.size());
+    auto t = value.get_tensor();
+    put_int(static_cast<uint64_t>(TF_TensorType(t.get())));
+    put_int(static_cast<uint64_t>(TF_NumDims(t.get())));
+    for (int d = 0; d < TF_NumDims(t.get()); d++)
+      put_int(static_cast<uint64_t>(TF_Dim(t.get(), d)));
+
+    if (TF_TensorType(t.get()) == TF_STRING) {
+      // The elements may point to heap storage, take what they point to
+      const auto* s = static_cast<const TF_TString*>(TF_TensorData(t.get()));
+      const size_t n = TF_TensorByteSize(t.get()) / sizeof(TF_TString);
+      for (size_t i = 0; i < n; i++)
+        put_string(TF_TString_GetDataPointer(&s[i]),
+                   TF_TString_GetSize(&s[i]));
+    } else {
+      put_string(TF_TensorData(t.get()), TF_TensorByteSize(t.get()));
+    }
+  }
+  put_int(outputs.size());
+  for (const auto& name : outputs)
+    put_string(name.data(), name.size());
+}
+
+inline std::string result_cache::request_bytes(
+    const std::vector<std::tuple<std::string, tensor>>& inputs,
+    const std::vector<std::string>& outputs) {
+  std::string r;
+  for_each_piece(inputs, outputs, [&r](const void* data, size_t len) {
+    r.append(static_cast<const char*>(data), len);
+  });
+  return r;
+}
+
+inline bool result_cache::same_request(
+    const std::string& request,
+    const std::vector<std::tuple<std::string, tensor>>& inputs,
+    const std::vector<std::string>& outputs) {
+  size_t pos = 0;
+  bool same = true;
+  for_each_piece(inputs, outputs, [&](const void* data, size_t len) {
+    if (!same)
+      return;
+    same = len <= request.size() - pos &&
+           (len == 0 || std::memcmp(request.data() + pos, data, len) == 0);
+    pos += len;
+  });
+  return same && pos == request.size();
+}
+
+inline result_cache::key result_cache::hash(
+    const std::vector<std::tuple<std::string, tensor>>& inputs,
+    const std::vector<std::string>& outputs) {
+  detail::hash128 h;
+  for_each_piece(inputs, outputs, [&h](const void* data, size_t len) {
+    h.update(data, len);
+  });
+  return h.digest();
+}
+
+inline std::vector<tensor> result_cache::operator()(
+    const std::vector<std::tuple<std::string, tensor>>& inputs,
+    const std::vector<std::string>& outputs) {
+  const key k = hash(inputs, outputs);
+
+  // Built on the first miss only, hits never copy the inputs
+  std::shared_ptr<const std::string> request;
+
+  // Whether this call is the one others with the same key wait for, false
+  // if the key collides with a different call already running
+  bool owner = true;
+  std::promise<std::shared_ptr<const value>> promise;
+  for (;;) {
+    // Take what the key maps to, the bytes are compared without the lock
+    std::shared_ptr<const value> cached;
+    pending_call running;
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      auto it = this->entries.find(k);
+      if (it != this->entries.end()) {
+        if (this->opts.ttl.count() > 0 && clock::now() >= it->second.expires)
+          this->erase(it);
+        else
+          cached = it->second.v;
+      }
+      auto p = this->pending.find(k);
+      if (p != this->pending.end())
+        running = p->second;
+    }
+
+    if (cached && same_request(*cached->request, inputs, outputs)) {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->hits++;
+      this->saved_seconds += cached->seconds;
+      auto it = this->entries.find(k);
+      if (it != this->entries.end() && it->second.v == cached)
+        this->lru.splice(this->lru.begin(), this->lru, it->second.lru);
+      return cached->outputs;
+    }
+
+    if (running.request && same_request(*running.request, inputs, outputs)) {
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->coalesced++;
+      }
+      auto v = running.result.get();
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->saved_seconds += v->seconds;
+      return v->outputs;
+    }
+
+    if (!request)
+      request = std::make_shared<const std::string>(
+          request_bytes(inputs, outputs));
+
+    // On a hash collision, the entry is replaced by the result of this call
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto it = this->entries.find(k);
+    auto p = this->pending.find(k);
+    const bool same_entry = it == this->entries.end() ?
+        !cached : it->second.v == cached;
+    const bool same_pending = p == this->pending.end() ?
+        !running.request : p->second.request == running.request;
+    if (!same_entry || !same_pending)
+      continue;  // Changed while unlocked, look again
+
+    this->misses++;
+    if (p == this->pending.end())
+      this->pending.emplace(k, pending_call{request,
+                                            promise.get_future().share()});
+    else
+      owner = false;
+    break;
+  }
+
+  std::shared_ptr<value> v = std::make_shared<value>();
+  try {
+    auto start = clock::now();
+    v->outputs = this->m(inputs, outputs);
+    v->seconds = std::chrono::duration<double>(clock::now() - start).count();
+  } catch (...) {
+    if (owner) {
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->pending.erase(k);
+      }
+      promise.set_exception(std::current_exception());
+    }
+    throw;
+  }
+  if (!owner)
+    return v->outputs;
+
+  v->request = request;
+  size_t size = request->size();
+  for (const auto& t : v->outputs)
+    size += TF_TensorByteSize(t.get_tensor().get());
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->pending.erase(k);
+
+    if (size <= this->opts.max_bytes) {
+      auto it = this->entries.find(k);
+      if (it != this->entries.end())
+        this->erase(it);
+
+      this->lru.push_front(k);
+      this->entries[k] = {v, size, clock::now() + this->opts.ttl,
+                          this->lru.begin()};
+      this->bytes += size;
+
+      while (this->bytes > this->opts.max_bytes) {
+        this->erase(this->entries.find(this->lru.back()));
+        this->evictions++;
+      }
+    }
+  }
+  promise.set_value(v);
+  return v->outputs;
+}
+
+inline void result_cache::erase(std::map<key, entry>::iterator it) {
+  this->bytes -= it->second.bytes;
+  this->lru.erase(it->second.lru);
+  this->entries.erase(it);
+}
+
+inline result_cache::stats result_cache::get_stats() const {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  stats s;
+  s.hits = this->hits;
+  s.misses = this->misses;
+  s.coalesced = this->coalesced;
+  s.evictions = this->evictions;
+  s.entries = this->entries.size();
+  s.bytes = this->bytes;
+  const size_t calls = this->hits + this->misses + this->coalesced;
+  s.hit_rate = calls > 0 ?
+      static_cast<double>(this->hits + this->coalesced) / calls : 0.0;
+  s.saved_seconds = this->saved_seconds;
+  return s;
+}
+
+inline void result_cache::clear() {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->entries.clear();
+  this->lru.clear();
+  this->bytes = 0;
+}
+
+}  // namespace cppflow
+
+#endif  // INCLUDE_CPPFLOW_RESULT_CACHE_H_
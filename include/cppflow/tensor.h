@@ -89,6 +89,14 @@ class tensor {
   tensor(const tensor &tensor) = default;
   tensor(tensor &&tensor) = default;
   explicit tensor(TFE_TensorHandle* handle);
+
+  /**
+   * Wraps a TF_Tensor, taking ownership of it
+   * The eager handle is only created when it is needed (eager ops,
+   * device()), so tensors that are only read with get_data() never touch
+   * the eager context.
+   * @param t The tensor to wrap
+   */
   explicit tensor(TF_Tensor* t);
 
   ~tensor() = default;
@@ -133,10 +141,11 @@ class tensor {
   //    TFE_TensorHandle is a TF_Tensor and the associated device,
   //        plus some data cache
 
+  // Creates the eager handle on first use if the tensor only wraps a
+  // TF_Tensor. Like get_tensor(), this lazy initialization is not
+  // synchronized: do not call it on the same object from several threads.
   // @todo Need to determine if we can mark the return value or *this as const
-  std::shared_ptr<TFE_TensorHandle> get_eager_handle() const {
-    return tfe_handle;
-  }
+  const std::shared_ptr<TFE_TensorHandle>& get_eager_handle() const;
 
   // Get the TF_Tensor data from the eager handle
   // Call `get_data<T>()` instead if possible
@@ -148,9 +157,10 @@ class tensor {
   std::shared_ptr<TF_Tensor> get_tensor() const;
 
   // DO NOT directly access this member, call get_eager_handle() instead
+  // It is null until first used for tensors created from a TF_Tensor
   // @todo This is kept as public to be compatible with existing code and
   //       should be mark as private
-  std::shared_ptr<TFE_TensorHandle> tfe_handle;
+  mutable std::shared_ptr<TFE_TensorHandle> tfe_handle;
 
  private:
   tensor(enum TF_DataType type, const void* data, size_t len,
@@ -237,17 +247,32 @@ inline tensor::tensor(TFE_TensorHandle* handle) {
 
 inline tensor::tensor(TF_Tensor* t) {
   this->tf_tensor = {t, TF_DeleteTensor};
-  this->tfe_handle = {TFE_NewTensorHandle(this->tf_tensor.get(),
-                                          context::get_status()),
-                      TFE_DeleteTensorHandle};
-  status_check(context::get_status());
+}
+
+inline const std::shared_ptr<TFE_TensorHandle>&
+tensor::get_eager_handle() const {
+  if (!this->tfe_handle && this->tf_tensor) {
+    this->tfe_handle = {TFE_NewTensorHandle(this->tf_tensor.get(),
+                                            context::get_status()),
+                        TFE_DeleteTensorHandle};
+    status_check(context::get_status());
+  }
+  return this->tfe_handle;
 }
 
 inline tensor tensor::shape() const {
+  // Without an eager handle the shape is known from the TF_Tensor
+  if (!this->tfe_handle && this->tf_tensor) {
+    std::vector<int64_t> dims(TF_NumDims(this->tf_tensor.get()));
+    for (decltype(dims.size()) i=0; i < dims.size(); i++)
+      dims[i] = TF_Dim(this->tf_tensor.get(), static_cast<int>(i));
+    return tensor(dims, {static_cast<int64_t>(dims.size())});
+  }
+
   auto op = TFE_NewOp(context::get_context(), "Shape", context::get_status());
   status_check(context::get_status());
 
-  TFE_OpAddInput(op, this->tfe_handle.get(), context::get_status());
+  TFE_OpAddInput(op, this->get_eager_handle().get(), context::get_status());
   status_check(context::get_status());
 
   // Output type should be int64_t
@@ -266,10 +291,10 @@ inline tensor tensor::shape() const {
 inline std::string tensor::device(bool on_memory) const {
   std::string res;
   if (on_memory)
-    res = TFE_TensorHandleBackingDeviceName(this->tfe_handle.get(),
+    res = TFE_TensorHandleBackingDeviceName(this->get_eager_handle().get(),
                                             context::get_status());
   else
-    res = std::string(TFE_TensorHandleDeviceName(this->tfe_handle.get(),
+    res = std::string(TFE_TensorHandleDeviceName(this->get_eager_handle().get(),
                                                  context::get_status()));
 
   status_check(context::get_status());
@@ -304,6 +329,8 @@ std::vector<T> tensor::get_data() const {
 }
 
 inline datatype tensor::dtype() const {
+  if (!this->tfe_handle && this->tf_tensor)
+    return TF_TensorType(this->tf_tensor.get());
   return TFE_TensorHandleDataType(this->tfe_handle.get());
 }
 
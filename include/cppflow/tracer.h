@@ -0,0 +1,404 @@
+// MIT License
+//
+// Copyright (c) 2026 The cppflow authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/*!
+ *  @file       tracer.h
+ *  @brief      Sampled per-op tracing of model calls
+ */
+
+#ifndef INCLUDE_CPPFLOW_TRACER_H_
+#define INCLUDE_CPPFLOW_TRACER_H_
+
+// C++ headers
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// CppFlow headers
+#include "cppflow/pb_helper.h"
+
+namespace cppflow {
+
+/**
+ * @class run_tracer
+ * @brief Collects the StepStats of a sample of the calls to a model
+ *
+ * When tracing is enabled, one in every N calls runs with
+ * RunOptions.trace_level = FULL_TRACE. The returned StepStats are aggregated
+ * per node and the last few steps are kept to be exported as a Chrome
+ * trace-event timeline (chrome://tracing or https://ui.perfetto.dev).
+ */
+class run_tracer {
+ public:
+  struct op_stats {
+    std::string name;  // Node name, or op type for top_op_types()
+    std::string op;
+    uint64_t count = 0;
+
+    // Self time excludes the nodes nested inside this one on the same thread
+    double self_micros = 0.0;
+    double total_micros = 0.0;
+    double max_self_micros = 0.0;
+  };
+
+  /**
+   * @param every_n Trace one in every_n calls, 0 disables tracing
+   * @param max_steps Number of traced steps kept for the timeline
+   */
+  void enable(uint64_t every_n, size_t max_steps = 16);
+  void disable() { enable(0); }
+  bool enabled() const { return interval.load(std::memory_order_relaxed); }
+
+  // Whether the current call should be traced, cheap when disabled
+  bool should_trace();
+
+  /**
+   * Adds a traced call
+   * @param run_metadata The serialized RunMetadata returned by the session
+   */
+  void record(const std::string& run_metadata);
+
+  // Forgets everything recorded so far
+  void clear();
+
+  uint64_t traced_steps() const;
+
+  /**
+   * @param n Number of entries to return
+   * @return The n nodes with the largest total self time
+   */
+  std::vector<op_stats> top_nodes(size_t n) const;
+
+  /**
+   * @param n Number of entries to return
+   * @return The n op types with the largest total self time
+   */
+  std::vector<op_stats> top_op_types(size_t n) const;
+
+  /**
+   * @param n Number of nodes in the report
+   * @return A text table of the hottest nodes
+   */
+  std::string report(size_t n = 20) const;
+
+  // The kept steps in Chrome trace-event JSON format
+  std::string chrome_trace() const;
+  void write_chrome_trace(const std::string& filename) const;
+
+  // Serialized RunOptions requesting a full trace
+  static const std::vector<uint8_t>& run_options();
+
+ private:
+  struct traced_node {
+    NodeExecStats stats;
+    int64_t self_nanos;
+  };
+
+  struct traced_device {
+    std::string device;
+    std::vector<traced_node> nodes;
+  };
+
+  static std::vector<traced_device> compute_self_time(
+      std::vector<DeviceStepStats> devices);
+  static std::string json_escape(const std::string& s);
+  static std::vector<op_stats> top(std::map<std::string, op_stats> stats,
+                                   size_t n);
+
+  std::atomic<uint64_t> interval{0};
+  std::atomic<uint64_t> counter{0};
+
+  mutable std::mutex mutex;
+  size_t max_steps = 16;
+  uint64_t steps = 0;
+  std::map<std::string, op_stats> nodes;
+  std::deque<std::vector<traced_device>> timeline;
+};  // Class run_tracer
+
+}  // namespace cppflow
+
+
+/******************************
+ *   IMPLEMENTATION DETAILS   *
+ ******************************/
+
+
+namespace cppflow {
+
+inline void run_tracer::enable(uint64_t every_n, size_t max_steps) {
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->max_steps = max_steps;
+    while (this->timeline.size() > max_steps)
+      this->timeline.pop_front();
+  }
+  this->interval.store(every_n, std::memory_order_relaxed);
+}
+
+inline bool run_tracer::should_trace() {
+  uint64_t n = this->interval.load(std::memory_order_relaxed);
+  if (n == 0)
+    return false;
+  return this->counter.fetch_add(1, std::memory_order_relaxed) % n == 0;
+}
+
+inline const std::vector<uint8_t>& run_tracer::run_options() {
+  static const std::vector<uint8_t> options = [] {
+    ProtoWriter writer;
+    writer.write_int(1, 3);  // trace_level = FULL_TRACE
+    return writer.data();
+  }();
+  return options;
+}
+
+inline std::vector<run_tracer::traced_device> run_tracer::compute_self_time(
+    std::vector<DeviceStepStats> devices) {
+  std::vector<traced_device> result;
+  for (auto& device : devices) {
+    traced_device traced;
+    traced.device = std::move(device.device);
+
+    auto& nodes = device.nodes;
+    std::sort(nodes.begin(), nodes.end(),
+              [](const NodeExecStats& a, const NodeExecStats& b) {
+                if (a.thread_id != b.thread_id) return a.thread_id < b.thread_id;
+                if (a.start_nanos != b.start_nanos)
+                  return a.start_nanos < b.start_nanos;
+                return a.all_end_rel_nanos > b.all_end_rel_nanos;
+              });
+
+    // Walk every thread with a stack of the enclosing nodes, charging the
+    // op time of each node to its direct parent
+    std::vector<size_t> stack;
+    for (auto& node : nodes) {
+      int64_t op_nanos = std::max<int64_t>(
+          0, node.op_end_rel_nanos - node.op_start_rel_nanos);
+      traced.nodes.push_back({std::move(node), op_nanos});
+      const auto& cur = traced.nodes.back().stats;
+
+      while (!stack.empty()) {
+        const auto& top = traced.nodes[stack.back()].stats;
+        if (top.thread_id == cur.thread_id &&
+            cur.start_nanos < top.start_nanos + top.all_end_rel_nanos)
+          break;
+        stack.pop_back();
+      }
+      if (!stack.empty())
+        traced.nodes[stack.back()].self_nanos -= op_nanos;
+      stack.push_back(traced.nodes.size() - 1);
+    }
+
+    for (auto& node : traced.nodes)
+      node.self_nanos = std::max<int64_t>(0, node.self_nanos);
+    result.push_back(std::move(traced));
+  }
+  return result;
+}
+
+inline void run_tracer::record(const std::string& run_metadata) {
+  auto devices = compute_self_time(ParseRunMetadataStepStats(run_metadata));
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->steps++;
+  for (const auto& device : devices) {
+    for (const auto& node : device.nodes) {
+      auto& s = this->nodes[node.stats.node_name];
+      s.name = node.stats.node_name;
+      s.op = node.stats.op;
+      s.count++;
+      double self = node.self_nanos / 1000.0;
+      s.self_micros += self;
+      s.total_micros += (node.stats.op_end_rel_nanos -
+                         node.stats.op_start_rel_nanos) / 1000.0;
+      s.max_self_micros = std::max(s.max_self_micros, self);
+    }
+  }
+
+  if (this->max_steps > 0) {
+    this->timeline.push_back(std::move(devices));
+    while (this->timeline.size() > this->max_steps)
+      this->timeline.pop_front();
+  }
+}
+
+inline void run_tracer::clear() {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->steps = 0;
+  this->nodes.clear();
+  this->timeline.clear();
+}
+
+inline uint64_t run_tracer::traced_steps() const {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->steps;
+}
+
+inline std::vector<run_tracer::op_stats> run_tracer::top(
+    std::map<std::string, op_stats> stats, size_t n) {
+  std::vector<op_stats> result;
+  result.reserve(stats.size());
+  for (auto& [name, s] : stats)
+    result.push_back(std::move(s));
+
+  std::sort(result.begin(), result.end(),
+            [](const op_stats& a, const op_stats& b) {
+              return a.self_micros > b.self_micros;
+            });
+  if (result.size() > n)
+    result.resize(n);
+  return result;
+}
+
+inline std::vector<run_tracer::op_stats> run_tracer::top_nodes(
+    size_t n) const {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return top(this->nodes, n);
+}
+
+inline std::vector<run_tracer::op_stats> run_tracer::top_op_types(
+    size_t n) const {
+  std::map<std::string, op_stats> types;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for (const auto& [name, s] : this->nodes) {
+      auto& t = types[s.op];
+      t.name = s.op;
+      t.op = s.op;
+      t.count += s.count;
+      t.self_micros += s.self_micros;
+      t.total_micros += s.total_micros;
+      t.max_self_micros = std::max(t.max_self_micros, s.max_self_micros);
+    }
+  }
+  return top(std::move(types), n);
+}
+
+inline std::string run_tracer::report(size_t n) const {
+  auto hot = this->top_nodes(n);
+  auto steps = this->traced_steps();
+
+  std::ostringstream os;
+  os << "Traced steps: " << steps << "\n";
+
+  char line[256];
+  std::snprintf(line, sizeof(line), "%13s %13s %13s %8s  %-20s %s\n",
+                "self/step us", "total/step us", "max self us", "count",
+                "op", "node");
+  os << line;
+  for (const auto& s : hot) {
+    double per_step = steps ? 1.0 / steps : 0.0;
+    std::snprintf(line, sizeof(line), "%13.1f %13.1f %13.1f %8llu  %-20s ",
+                  s.self_micros * per_step, s.total_micros * per_step,
+                  s.max_self_micros,
+                  static_cast<unsigned long long>(s.count),  // NOLINT
+                  s.op.c_str());
+    os << line << s.name << "\n";
+  }
+  return os.str();
+}
+
+inline std::string run_tracer::json_escape(const std::string& s) {
+  std::string out;
+  out.reserve(s.size());
+  for (char c : s) {
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+          out += buf;
+        } else {
+          out += c;
+        }
+    }
+  }
+  return out;
+}
+
+inline std::string run_tracer::chrome_trace() const {
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  // One process per device, named after it
+  std::map<std::string, size_t> pids;
+  for (const auto& step : this->timeline)
+    for (const auto& device : step)
+      pids.emplace(device.device, pids.size());
+
+  std::ostringstream os;
+  os << "{\"traceEvents\":[";
+  bool first = true;
+  auto sep = [&] { if (!first) os << ","; first = false; };
+
+  for (const auto& [device, pid] : pids) {
+    sep();
+    os << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+       << ",\"args\":{\"name\":\"" << json_escape(device) << "\"}}";
+  }
+
+  os.precision(3);
+  os << std::fixed;
+  for (const auto& step : this->timeline) {
+    for (const auto& device : step) {
+      size_t pid = pids[device.device];
+      for (const auto& node : device.nodes) {
+        const auto& n = node.stats;
+        sep();
+        os << "{\"name\":\"" << json_escape(n.op.empty() ? n.node_name : n.op)
+           << "\",\"cat\":\"Op\",\"ph\":\"X\",\"pid\":" << pid
+           << ",\"tid\":" << n.thread_id
+           << ",\"ts\":" << (n.start_nanos + n.op_start_rel_nanos) / 1000.0
+           << ",\"dur\":"
+           << (n.op_end_rel_nanos - n.op_start_rel_nanos) / 1000.0
+           << ",\"args\":{\"name\":\"" << json_escape(n.node_name)
+           << "\",\"op\":\"" << json_escape(n.op)
+           << "\",\"self_us\":" << node.self_nanos / 1000.0 << "}}";
+      }
+    }
+  }
+  os << "]}";
+  return os.str();
+}
+
+inline void run_tracer::write_chrome_trace(const std::string& filename) const {
+  std::ofstream file(filename);
+  if (!file.is_open())
+    throw std::runtime_error("Unable to open file: " + filename);
+  file << this->chrome_trace();
+}
+
+}  // namespace cppflow
+
+#endif  // INCLUDE_CPPFLOW_TRACER_H_